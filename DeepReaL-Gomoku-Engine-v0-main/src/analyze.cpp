@@ -0,0 +1,210 @@
+// ============================================================================
+// DeepReaL Gomoku Engine v0 - Batch position analysis
+// ============================================================================
+
+#include "analyze.h"
+#include "search.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+constexpr int ANALYZE_WINDOW_PER_THREAD = 64;  // Results buffered ahead of the output
+
+// ============================================================================
+// Input parsing
+// ============================================================================
+static bool parse_move_list(const char* text, size_t len, Board& board, string& error) {
+    size_t i = 0;
+    while (i < len) {
+        if (text[i] == ' ' || text[i] == ',' || text[i] == '\t') {
+            i++;
+            continue;
+        }
+        if (text[i] < '0' || text[i] > '9') {
+            error = "invalid character";
+            return false;
+        }
+        int move = 0;
+        while (i < len && text[i] >= '0' && text[i] <= '9' && move < 1000) {
+            move = move * 10 + (text[i++] - '0');
+        }
+        if (board.isTerminal()) {
+            error = "move after the game ended";
+            return false;
+        }
+        if (!board.legal(move)) {
+            error = "illegal move " + to_string(move);
+            return false;
+        }
+        board.set(move);
+    }
+    return true;
+}
+
+// Exactly 225 cell characters (the text need not be NUL-terminated)
+static bool is_cell_text(const char* text, size_t len) {
+    if (len != 225) return false;
+    for (size_t i = 0; i < len; i++) {
+        if (!memchr(".-XxOo012", text[i], 9)) return false;
+    }
+    return true;
+}
+
+bool parse_position(const char* text, size_t len, Board& board, string& error) {
+    while (len > 0 && (text[len - 1] == '\r' || text[len - 1] == ' ' || text[len - 1] == '\t')) len--;
+    board.init();
+    bool ok;
+    if (is_cell_text(text, len)) {
+        ok = board.load(text);
+        if (!ok) error = "invalid board";
+    } else {
+        ok = parse_move_list(text, len, board, error);
+    }
+    if (!ok) return false;
+    if (board.isTerminal()) {
+        error = "position is terminal";
+        return false;
+    }
+    if (board.cnt > 0 && board.nxt.empty()) {
+        error = "no legal moves";
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// Ordered output: results are written strictly in input order. A worker
+// only starts position i once i is within 'window' of the next position to
+// be written, which bounds the buffered results.
+// ============================================================================
+struct OrderedOutput {
+    FILE* out;
+    size_t window;
+    vector<string> slots;
+    vector<char> ready;
+    size_t next = 0;        // Next position to write
+    mutex m;
+    condition_variable cv;
+
+    OrderedOutput(FILE* f, size_t w) : out(f), window(w), slots(w), ready(w, 0) {}
+
+    void wait_slot(size_t i) {
+        unique_lock<mutex> lock(m);
+        cv.wait(lock, [&]() { return i < next + window; });
+    }
+
+    void put(size_t i, string&& line) {
+        lock_guard<mutex> lock(m);
+        slots[i % window] = move(line);
+        ready[i % window] = 1;
+        while (ready[next % window]) {
+            string& s = slots[next % window];
+            fwrite(s.data(), 1, s.size(), out);
+            ready[next % window] = 0;
+            next++;
+        }
+        cv.notify_all();
+    }
+};
+
+static string analyze_line(long long line_no, const char* text, size_t len, const AnalyzeConfig& cfg) {
+    char buf[256];
+    Board board;
+    string error;
+    if (!parse_position(text, len, board, error)) {
+        snprintf(buf, sizeof(buf), "{\"line\":%lld,\"error\":\"%s\"}\n", line_no, error.c_str());
+        return buf;
+    }
+
+    SearchLimits limits;
+    limits.iters = cfg.iters;
+    limits.movetime_ms = cfg.movetime_ms;
+    limits.rng_stream = line_no;
+    int side = board.side();
+    int best = getBest(board, limits);
+
+    // Summed over all trees with Threads > 1, like the choice of 'best'
+    RootStats root;
+    root_stats(root);
+    int best_visits = best >= 0 ? root.child_visits[best] : 0;
+    double winrate = 0.5;
+    if (root.visits > 0) {
+        double black = (double)root.wins / (2.0 * root.visits);
+        winrate = side == 0 ? black : 1.0 - black;
+    }
+    snprintf(buf, sizeof(buf),
+             "{\"line\":%lld,\"best\":%d,\"visits\":%d,\"root_visits\":%d,\"winrate\":%.4f,\"time_ms\":%.1f}\n",
+             line_no, best, best_visits, root.visits, winrate, search_stats.total_ms);
+    return buf;
+}
+
+long long run_analyze(const string& path, const AnalyzeConfig& cfg, FILE* out) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+    size_t size = st.st_size;
+    if (size == 0) {
+        close(fd);
+        return 0;
+    }
+    const char* data = (const char*)mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return -1;
+    madvise((void*)data, size, MADV_SEQUENTIAL);
+
+    // Index the positions: (offset, line number) of every non-skipped line
+    struct Job {
+        size_t ofs;
+        long long line_no;
+    };
+    vector<Job> jobs;
+    vector<size_t> ends;
+    long long line_no = 0;
+    for (size_t pos = 0; pos < size;) {
+        const char* nl = (const char*)memchr(data + pos, '\n', size - pos);
+        size_t end = nl ? nl - data : size;
+        line_no++;
+        size_t first = pos;
+        while (first < end && (data[first] == ' ' || data[first] == '\t' || data[first] == '\r')) first++;
+        if (first < end && data[first] != '#') {
+            jobs.push_back({first, line_no});
+            ends.push_back(end);
+        }
+        pos = end + 1;
+    }
+
+    int threads = cfg.threads > 0 ? cfg.threads : max(1u, thread::hardware_concurrency());
+    threads = max(1, min<int>(threads, jobs.size()));
+    OrderedOutput output(out, (size_t)threads * ANALYZE_WINDOW_PER_THREAD);
+    atomic<size_t> next_job(0);
+
+    auto worker = [&]() {
+        size_t i;
+        while ((i = next_job++) < jobs.size()) {
+            output.wait_slot(i);
+            const Job& job = jobs[i];
+            output.put(i, analyze_line(job.line_no, data + job.ofs, ends[i] - job.ofs, cfg));
+        }
+    };
+    vector<thread> pool;
+    for (int t = 0; t < threads; t++) pool.emplace_back(worker);
+    for (thread& t : pool) t.join();
+    fflush(out);
+
+    munmap((void*)data, size);
+    return jobs.size();
+}
@@ -0,0 +1,39 @@
+// ============================================================================
+// DeepReaL Gomoku Engine v0 - Batch position analysis
+// Searches every position of a file on a pool of worker threads (each with
+// its own node pool) and writes one JSON line per position, in input order.
+//
+// Input: one position per line, either a move list (cell indices separated
+// by spaces or commas, played alternately from the empty board) or a
+// 225-character board string in row-major order (cells as in Board::load;
+// the side to move follows from the stone counts).
+// Blank lines and lines starting with '#' are skipped.
+// ============================================================================
+
+#ifndef ANALYZE_H
+#define ANALYZE_H
+
+#include "board.h"
+#include <cstdio>
+#include <string>
+
+struct AnalyzeConfig {
+    int threads = 0;        // Worker threads (0 = hardware concurrency)
+    int iters = 10000;      // Iterations per position (0 = only movetime)
+    int movetime_ms = 0;    // Time per position (0 = only iters)
+};
+
+// Parse one input line into 'board'. Returns false and sets 'error' if the
+// line is neither a legal move list nor a valid board string.
+bool parse_position(const char* text, size_t len, Board& board, std::string& error);
+
+// Analyse every position in the file at 'path' and write JSONL to 'out':
+//   {"line":N,"best":M,"visits":V,"root_visits":R,"winrate":W,"time_ms":T}
+// or {"line":N,"error":"..."} for lines that cannot be searched. 'line' is
+// the 1-based line number in the file. Uses the current search options;
+// position N searches with rollout stream N, so output does not depend on
+// the thread count. Returns the number of positions, or -1 if the file
+// cannot be read.
+long long run_analyze(const std::string& path, const AnalyzeConfig& cfg, FILE* out);
+
+#endif // ANALYZE_H
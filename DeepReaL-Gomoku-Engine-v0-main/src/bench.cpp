@@ -0,0 +1,102 @@
+#include "bench.h"
+#include "board.h"
+#include "search.h"
+#include <chrono>
+#include <sstream>
+#include <vector>
+
+// ============================================================================
+// Benchmark positions (move sequences from an empty board)
+// ============================================================================
+struct BenchPosition {
+    const char* name;
+    std::vector<int> moves;
+};
+
+static const BenchPosition bench_positions[] = {
+    // Prefixes of the 32-move game from test_performance (white completes
+    // five with its 7th stone, so later positions are terminal)
+    {"game_8", {112, 113, 126, 98, 96, 128, 110, 82}},
+    {"game_12", {112, 113, 126, 98, 96, 128, 110, 82, 142, 83, 125, 99}},
+    // Black completes an open four
+    {"open4_win", {111, 0, 112, 32, 113, 64, 114, 96}},
+    // Black extends a live three
+    {"live3_win", {110, 0, 112, 32, 113, 64}},
+    // White must block a live three
+    {"live3_defend", {110, 0, 112, 32, 113}},
+    // White must block an open four
+    {"four_defend", {79, 139, 80, 140, 81, 141, 82}},
+    // Both sides have four in a row, black to move
+    {"four_race", {79, 139, 80, 140, 81, 141, 82, 142}},
+    // Two live twos, either side to move
+    {"two_live2_x", {84, 14, 85, 194, 112, 210, 127, 224}},
+    {"two_live2_o", {84, 14, 85, 194, 112, 210, 127}},
+    // Live threes blocked by a white stone at various points
+    {"blocked_outer", {110, 109, 112, 0, 113}},
+    {"blocked_gap", {112, 114, 113, 0, 115}},
+    {"blocked_end", {111, 110, 112, 0, 113}},
+};
+
+// FNV-1a over the search tree: node count plus each node's move, visits and
+// wins. Any change to selection, expansion or rollouts alters it.
+static uint64_t tree_signature(uint64_t h) {
+    auto mix = [&h](uint64_t v) {
+        for (int i = 0; i < 8; i++) {
+            h ^= (v >> (i * 8)) & 0xff;
+            h *= 0x100000001b3ULL;
+        }
+    };
+    mix((uint64_t)node_count);
+    for (int i = 0; i < node_count; i++) {
+        mix((uint64_t)(uint32_t)nodes[i].move);
+        mix((uint64_t)(uint32_t)nodes[i].visits);
+        mix((uint64_t)(uint32_t)nodes[i].wins);
+    }
+    return h;
+}
+
+uint64_t run_bench(int iters, const std::function<void(const std::string&)>& out) {
+    if (iters <= 0) iters = BENCH_ITERS;
+
+    long long total_iters = 0;
+    uint64_t signature = 0xcbf29ce484222325ULL;
+    double total_ms = 0;
+    int count = 0;
+
+    for (const BenchPosition& pos : bench_positions) {
+        Board board;
+        board.init();
+        for (int m : pos.moves) board.set(m);
+
+        // Fresh tree (getBest re-seeds the RNG) so every run searches identically
+        SearchLimits limits;
+        limits.iters = iters;
+        limits.reuse_tree = false;
+
+        auto start = std::chrono::steady_clock::now();
+        int best = getBest(board, limits);
+        auto end = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+        total_iters += search_stats.iterations;
+        signature = tree_signature(signature);
+        total_ms += ms;
+        count++;
+
+        std::ostringstream oss;
+        oss << "bench " << pos.name << " moves " << pos.moves.size()
+            << " bestmove " << best << " iters " << search_stats.iterations
+            << " nodes " << search_stats.nodes_allocated
+            << " time " << (long long)ms
+            << " nps " << (ms > 0 ? (long long)(search_stats.iterations * 1000 / ms) : 0);
+        out(oss.str());
+    }
+
+    std::ostringstream oss;
+    oss << "bench total positions " << count << " iters " << total_iters
+        << " time " << (long long)total_ms
+        << " nps " << (total_ms > 0 ? (long long)(total_iters * 1000 / total_ms) : 0)
+        << " signature " << std::hex << signature;
+    out(oss.str());
+    return signature;
+}
@@ -0,0 +1,23 @@
+// ============================================================================
+// DeepReaL Gomoku Engine v0 - Deterministic search benchmark
+// Searches a fixed set of positions with a fixed iteration count, each
+// search seeded from the SEED option. The signature (a hash of every final
+// search tree) only changes when search behaviour changes, so it doubles as
+// a regression check.
+// ============================================================================
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+constexpr int BENCH_ITERS = 10000;  // Default iterations per position
+
+// Run the benchmark, passing one line per position and a final summary
+// line to 'out'. Uses the current search options; the persistent tree is
+// discarded. Returns the signature.
+uint64_t run_bench(int iters, const std::function<void(const std::string&)>& out);
+
+#endif // BENCH_H
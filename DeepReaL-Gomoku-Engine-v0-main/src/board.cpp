@@ -1,4 +1,57 @@
 #include "board.h"
+#include "profile.h"
+#include <algorithm>
+#include <cstdlib>
+
+// Length of diagonal line i (0-28)
+static inline int diag_len(int i) {
+    return 15 - std::abs(i - 14);
+}
+
+// ============================================================================
+// Pattern count steps, per window state of a player (see pattern_info):
+// the window's own count in packed form, and the change when that player's
+// stone lands inside the window (grow) or on a neighbour cell (close).
+// An opponent stone inside the window removes it.
+// ============================================================================
+struct PatternSteps {
+    uint64_t unit[32];
+    uint64_t grow[32];
+    uint64_t close[32];
+};
+
+static constexpr int window_type(int own, bool blocked, bool open) {
+    return blocked || own < 2 || own > 4 ? PAT_NONE : (own - 1) * 2 - 1 + (open ? 1 : 0);
+}
+
+static constexpr uint64_t type_unit(int t) {
+    return t == PAT_NONE ? 0 : 1ULL << (PATTERN_BITS * (t - 1));
+}
+
+static constexpr PatternSteps make_pattern_steps() {
+    PatternSteps st{};
+    for (int v = 0; v < 32; v++) {
+        int own = v & 7;
+        bool blocked = (v >> 3) & 1, open = (v >> 4) & 1;
+        st.unit[v] = type_unit(window_type(own, blocked, open));
+        st.grow[v] = type_unit(window_type(own + 1, blocked, open)) - st.unit[v];
+        st.close[v] = type_unit(window_type(own, blocked, false)) - st.unit[v];
+    }
+    return st;
+}
+
+static constexpr PatternSteps pattern_steps = make_pattern_steps();
+
+// Line mask extended by 6 off-board cells on each side: position p is bit
+// p + 6, so every window around a move reads whole cells
+static inline unsigned line_ext(int mask, int len) {
+    return ((unsigned)mask << 6) | 0x3Fu | (~0u << (len + 6));
+}
+
+// State of the window whose 7 cells start at bit s
+static inline int window_info(unsigned ext_own, unsigned ext_opp, int s) {
+    return pattern_info[((ext_own >> s) & 127) | (((ext_opp >> s) & 127) << 7)];
+}
 
 // ============================================================================
 // Board::init - Clear the board to initial state
@@ -17,6 +70,9 @@ void Board::init() {
         diag2[0][i] = diag2[1][i] = 0;
     }
     
+    pat[0] = pat[1] = 0;
+    track_patterns = false;
+    
     cnt = 0;
     res = -1;  // Game ongoing
     last_move = -1;  // No moves yet
@@ -26,6 +82,7 @@ void Board::init() {
 // Board::set - Make a move at the given index
 // ============================================================================
 void Board::set(int index) {
+    PROFILE_SCOPE(PROF_BOARD_SET);
     int side = cnt & 1;  // 0 = black, 1 = white
     int r = row_id[index];
     int c = col_id[index];
@@ -33,11 +90,46 @@ void Board::set(int index) {
     // Update bitboard
     b[side] |= f[index];
 
+    // Pattern counts, from the masks before the move. On each line, windows
+    // 0-6 of the 13 cells q-6 .. q+6 are those with q as right neighbour
+    // (0), inside (1-5) or left neighbour (6); windows that reach off the
+    // line hold off-board cells and never count. A side's counts can only
+    // change with at least one (mover) or two (opponent) of its stones
+    // within 5 cells of q. The changes are summed in registers: packed
+    // counts add and subtract exactly as long as every final count fits.
+    int d1 = diag1_idx[index], d2 = diag2_idx[index];
+    if (track_patterns) {
+        int o = 1 - side;
+        const int len[4] = {15, 15, diag_len(d1), diag_len(d2)};
+        const int pos[4] = {c, r, diag1_idy[index], diag2_idy[index]};
+        const int own_mask[4] = {row[side][r], col[side][c], diag1[side][d1], diag2[side][d2]};
+        const int opp_mask[4] = {row[o][r], col[o][c], diag1[o][d1], diag2[o][d2]};
+        uint64_t mine = 0, theirs = 0;
+        for (int l = 0; l < 4; l++) {
+            int q = pos[l];
+            unsigned near = (0x7FFu << q) >> 5;
+            unsigned own = line_ext(own_mask[l], len[l]) >> q, opp = line_ext(opp_mask[l], len[l]) >> q;
+            if (own_mask[l] & near) {
+                mine += pattern_steps.close[window_info(own, opp, 0)];
+                for (int w = 1; w <= 5; w++) mine += pattern_steps.grow[window_info(own, opp, w)];
+                mine += pattern_steps.close[window_info(own, opp, 6)];
+            }
+            unsigned opp_near = opp_mask[l] & near;
+            if (opp_near & (opp_near - 1)) {
+                theirs += pattern_steps.close[window_info(opp, own, 0)];
+                for (int w = 1; w <= 5; w++) theirs -= pattern_steps.unit[window_info(opp, own, w)];
+                theirs += pattern_steps.close[window_info(opp, own, 6)];
+            }
+        }
+        pat[side] += mine;
+        pat[o] += theirs;
+    }
+
     // Update line masks for this player
     row[side][r] |= (1 << c);
     col[side][c] |= (1 << r);
-    diag1[side][diag1_idx[index]] |= (1 << diag1_idy[index]);
-    diag2[side][diag2_idx[index]] |= (1 << diag2_idy[index]);
+    diag1[side][d1] |= (1 << diag1_idy[index]);
+    diag2[side][d2] |= (1 << diag2_idy[index]);
 
     // Update next legal moves
     nxt |= cheb2[index];
@@ -49,8 +141,8 @@ void Board::set(int index) {
     // Check for win using current player's line masks
     if (win_table[row[side][r]] || 
         win_table[col[side][c]] || 
-        win_table[diag1[side][diag1_idx[index]]] || 
-        win_table[diag2[side][diag2_idx[index]]]) {
+        win_table[diag1[side][d1]] || 
+        win_table[diag2[side][d2]]) {
         // Current player (side) wins
         // res = 1 means black wins, res = 0 means white wins
         res = (side == 0) ? 1 : 0;
@@ -59,3 +151,82 @@ void Board::set(int index) {
     last_move = index;  // Track the last move
     cnt++;
 }
+
+// ============================================================================
+// Board::count_patterns - Pattern windows of every line, from scratch
+// ============================================================================
+static void count_line(uint64_t out[2], int len, int mask_b, int mask_w) {
+    unsigned ext_b = line_ext(mask_b, len), ext_w = line_ext(mask_w, len);
+    for (int p = 0; p + 5 <= len; p++) {  // Windows at line positions 0 .. len-5
+        out[0] += pattern_steps.unit[window_info(ext_b, ext_w, p + 5)];
+        out[1] += pattern_steps.unit[window_info(ext_w, ext_b, p + 5)];
+    }
+}
+
+void Board::count_patterns(uint64_t out[2]) const {
+    out[0] = out[1] = 0;
+    for (int i = 0; i < 15; i++) {
+        count_line(out, 15, row[0][i], row[1][i]);
+        count_line(out, 15, col[0][i], col[1][i]);
+    }
+    for (int i = 0; i < 29; i++) {
+        count_line(out, diag_len(i), diag1[0][i], diag1[1][i]);
+        count_line(out, diag_len(i), diag2[0][i], diag2[1][i]);
+    }
+}
+
+void Board::enable_patterns() {
+    count_patterns(pat);
+    track_patterns = true;
+}
+
+// ============================================================================
+// Board::load - Set up a position from a 225-cell string
+// ============================================================================
+bool Board::load(const char* cells, int to_move) {
+    int stones[2][113];  // Black has at most 113 stones, white at most 112
+    int count[2] = {0, 0};
+    for (int i = 0; i < 225; i++) {
+        int s;
+        switch (cells[i]) {
+            case '.': case '-': case '0': continue;
+            case 'X': case 'x': case '1': s = 0; break;
+            case 'O': case 'o': case '2': s = 1; break;
+            default: return false;
+        }
+        if (count[s] == 113) return false;
+        stones[s][count[s]++] = i;
+    }
+    int implied = count[0] == count[1] ? 0 : count[0] == count[1] + 1 ? 1 : -1;
+    if (implied == -1 || (to_move != -1 && to_move != implied)) return false;
+    
+    init();
+    for (int i = 0; i < count[0]; i++) {
+        set(stones[0][i]);
+        if (i < count[1]) set(stones[1][i]);
+    }
+    return true;
+}
+
+// ============================================================================
+// Board::symmetries - Which of the 8 board symmetries preserve the position
+// Only stones are checked, so the cost is O(stones) per symmetry.
+// ============================================================================
+int Board::symmetries() const {
+    int mask = (1 << NUM_SYMMETRIES) - 1;
+
+    for (int side = 0; side < 2 && mask != 1; side++) {
+        lbit256 stones = b[side];
+        while (!stones.empty() && mask != 1) {
+            int idx = stones.popbit();
+            for (int k = 1; k < NUM_SYMMETRIES; k++) {
+                if ((mask >> k) & 1) {
+                    if (!b[side].get(sym_table[k][idx])) {
+                        mask &= ~(1 << k);
+                    }
+                }
+            }
+        }
+    }
+    return mask;
+}
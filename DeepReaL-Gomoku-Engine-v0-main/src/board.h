@@ -4,11 +4,22 @@
 #include <cstdint>
 #include <cstring>
 
+// WebAssembly builds with -msimd128 keep each lbit256 as two v128 halves
+// and do the whole-board operations with simd128 instructions
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define LBIT256_SIMD128 1
+#endif
+
 // ============================================================================
 // lbit256: 256-bit integer using 4 unsigned long long
 // ============================================================================
 struct lbit256 {
+#ifdef LBIT256_SIMD128
+    alignas(16) unsigned long long d[4];  // Low half d[0..1], high half d[2..3]
+#else
     unsigned long long d[4];  // d[0]: bits 0-63, d[1]: 64-127, d[2]: 128-191, d[3]: 192-255
+#endif
 
     inline lbit256() : d{0, 0, 0, 0} {}
     
@@ -16,6 +27,51 @@ struct lbit256 {
                    unsigned long long d2, unsigned long long d3) 
         : d{d0, d1, d2, d3} {}
 
+#ifdef LBIT256_SIMD128
+    inline lbit256(v128_t lo, v128_t hi) {
+        wasm_v128_store(d, lo);
+        wasm_v128_store(d + 2, hi);
+    }
+    inline v128_t lo() const { return wasm_v128_load(d); }
+    inline v128_t hi() const { return wasm_v128_load(d + 2); }
+
+    inline lbit256 operator|(const lbit256& o) const {
+        return lbit256(wasm_v128_or(lo(), o.lo()), wasm_v128_or(hi(), o.hi()));
+    }
+
+    inline lbit256 operator&(const lbit256& o) const {
+        return lbit256(wasm_v128_and(lo(), o.lo()), wasm_v128_and(hi(), o.hi()));
+    }
+
+    inline lbit256 operator~() const {
+        return lbit256(wasm_v128_not(lo()), wasm_v128_not(hi()));
+    }
+
+    inline lbit256& operator|=(const lbit256& o) {
+        wasm_v128_store(d, wasm_v128_or(lo(), o.lo()));
+        wasm_v128_store(d + 2, wasm_v128_or(hi(), o.hi()));
+        return *this;
+    }
+
+    inline lbit256& operator&=(const lbit256& o) {
+        wasm_v128_store(d, wasm_v128_and(lo(), o.lo()));
+        wasm_v128_store(d + 2, wasm_v128_and(hi(), o.hi()));
+        return *this;
+    }
+
+    inline bool empty() const {
+        return !wasm_v128_any_true(wasm_v128_or(lo(), hi()));
+    }
+
+    // Per-byte popcount of both halves (at most 16 per byte), then
+    // pairwise widening adds down to four 32-bit lanes
+    inline int popcount() const {
+        v128_t bytes = wasm_i8x16_add(wasm_i8x16_popcnt(lo()), wasm_i8x16_popcnt(hi()));
+        v128_t lanes = wasm_u32x4_extadd_pairwise_u16x8(wasm_u16x8_extadd_pairwise_u8x16(bytes));
+        return wasm_i32x4_extract_lane(lanes, 0) + wasm_i32x4_extract_lane(lanes, 1) +
+               wasm_i32x4_extract_lane(lanes, 2) + wasm_i32x4_extract_lane(lanes, 3);
+    }
+#else
     // Bitwise OR
     inline lbit256 operator|(const lbit256& o) const {
         return lbit256(d[0] | o.d[0], d[1] | o.d[1], d[2] | o.d[2], d[3] | o.d[3]);
@@ -53,6 +109,7 @@ struct lbit256 {
         return __builtin_popcountll(d[0]) + __builtin_popcountll(d[1]) +
                __builtin_popcountll(d[2]) + __builtin_popcountll(d[3]);
     }
+#endif
 
     // Set bit at index
     inline void set(int idx) {
@@ -96,6 +153,23 @@ struct lbit256 {
     }
 };
 
+// ============================================================================
+// Pattern counts: a 5-cell window of a line holding k = 2..4 stones of one
+// side and none of the other is a two, three or four of that side. It is
+// open when the cells on both sides of the window are empty, closed when
+// either is a stone or off the board. A shape with room around it lies in
+// several windows, so open shapes weigh more than blocked ones.
+// ============================================================================
+constexpr int PAT_NONE = 0;
+constexpr int PAT_TWO = 1;
+constexpr int PAT_OPEN_TWO = 2;
+constexpr int PAT_THREE = 3;
+constexpr int PAT_OPEN_THREE = 4;
+constexpr int PAT_FOUR = 5;             // One move from five
+constexpr int PAT_OPEN_FOUR = 6;
+constexpr int PATTERN_TYPES = 7;
+constexpr int PATTERN_BITS = 10;        // Per count in Board::pat (a player has at most 572 windows)
+
 // ============================================================================
 // Board: Gomoku board representation
 // ============================================================================
@@ -109,12 +183,45 @@ struct Board {
     int cnt;            // Move count (cnt & 1 == 0 means black to move)
     int res;            // Result: -1 = ongoing, 0 = white win, 1 = black win
     int last_move;      // Last move played (-1 if none)
+    uint64_t pat[2];    // Pattern window counts per player, PATTERN_BITS each (see pattern_count)
+    bool track_patterns;  // set() keeps pat in sync (off after init)
 
     void init();
     void set(int index);
+
+    // Count pat from scratch and have set() keep it in sync from now on.
+    // Off by default: the update re-reads 28 windows per move, which plain
+    // rollouts never look at.
+    void enable_patterns();
+
+    // Windows of pattern type t (PAT_TWO..PAT_OPEN_FOUR) for player s
+    inline int pattern_count(int s, int t) const {
+        return (int)(pat[s] >> (PATTERN_BITS * (t - 1))) & ((1 << PATTERN_BITS) - 1);
+    }
+    
+    // Count the pattern windows of all 88 lines from scratch (what set()
+    // maintains incrementally in pat)
+    void count_patterns(uint64_t out[2]) const;
+
+    // Bitmask of the board symmetries (bit k = sym_table[k]) that map
+    // b[0]/b[1] onto themselves. Bit 0 (identity) is always set.
+    int symmetries() const;
     
     inline bool isTerminal() const { return res != -1; }
     inline int side() const { return cnt & 1; }  // 0 = black, 1 = white
+    
+    // True if 'index' is an empty cell and the game is still going
+    inline bool legal(int index) const {
+        return index >= 0 && index < 225 && res == -1 && !b[0].get(index) && !b[1].get(index);
+    }
+    
+    // Set up a position from 225 cells in row-major order ('.', '-' or '0'
+    // empty; 'X', 'x' or '1' black; 'O', 'o' or '2' white). side is the side
+    // to move (0 = black, 1 = white, -1 = from the stone counts); black must
+    // have as many stones as white (black to move) or one more. Stones are
+    // placed alternately, so last_move is the last white or black stone in
+    // index order. Returns false on invalid cells or counts.
+    bool load(const char* cells, int side = -1);
 };
 
 // ============================================================================
@@ -130,6 +237,18 @@ extern lbit256 f[225];
 extern lbit256 cheb2[225];
 extern bool win_table[1 << 15];
 
+// Pattern window state of one player, indexed by 7 cells of a line (the
+// 5-cell window and one neighbour on each side) as own bits | opponent bits
+// << 7, off-board cells having both bits set: own stones in the window
+// (bits 0-2), window blocked by an opponent stone or the edge (3), both
+// neighbours empty (4)
+extern uint8_t pattern_info[1 << 14];
+
+// D4 symmetries of the 15x15 board: sym_table[k][idx] is the image of idx
+// under symmetry k (0 = identity, 1-3 = rotations, 4-7 = reflections)
+constexpr int NUM_SYMMETRIES = 8;
+extern int sym_table[NUM_SYMMETRIES][225];
+
 // Mask for valid board positions (bits 0-224)
 extern lbit256 board_mask;
 
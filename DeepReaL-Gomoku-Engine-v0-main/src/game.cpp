@@ -0,0 +1,73 @@
+// ============================================================================
+// DeepReaL Gomoku Engine v0 - Game state for the front ends
+// ============================================================================
+
+#include "game.h"
+
+using namespace std;
+
+void GameState::reset() {
+    base.init();
+    board.init();
+    moves.clear();
+}
+
+bool GameState::play(int move) {
+    if (!board.legal(move)) return false;
+    board.set(move);
+    moves.push_back(move);
+    return true;
+}
+
+bool GameState::takeback(int n) {
+    if (n < 0 || n > (int)moves.size()) return false;
+    moves.resize(moves.size() - n);
+    board = base;
+    for (int m : moves) board.set(m);
+    return true;
+}
+
+string GameState::takeback(istringstream& args) {
+    int n = 1;
+    if (!(args >> ws).eof() && (!(args >> n) || n < 1)) return "error: invalid takeback count";
+    if (!takeback(n)) return "error: cannot take back " + to_string(n) + " moves";
+    return "";
+}
+
+string GameState::set_position(istringstream& args) {
+    GameState next;
+    string tok, word;  // word: keyword after the position, if any
+    args >> tok;
+    if (tok == "startpos") {
+        next.base.init();
+        args >> word;
+    } else if (tok == "board") {
+        string cells;
+        args >> cells >> word;
+        int side = -1;
+        if (word == "side") {
+            string s;
+            word.clear();
+            args >> s >> word;
+            if (s == "0" || s == "b" || s == "black") side = 0;
+            else if (s == "1" || s == "w" || s == "white") side = 1;
+            else return "error: invalid side";
+        }
+        if (cells.size() != 225 || !next.base.load(cells.c_str(), side)) return "error: invalid board";
+    } else {
+        return "error: expected startpos or board";
+    }
+    
+    next.board = next.base;
+    if (word == "moves") {
+        int move;
+        while (args >> move) {
+            if (!next.play(move)) return "error: illegal move " + to_string(move);
+        }
+        if (!args.eof()) return "error: invalid move list";
+    } else if (!word.empty()) {
+        return "error: unexpected " + word;
+    }
+    *this = next;
+    return "";
+}
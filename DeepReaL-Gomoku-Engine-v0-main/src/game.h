@@ -0,0 +1,43 @@
+// ============================================================================
+// DeepReaL Gomoku Engine v0 - Game state for the front ends
+// The UCI loop and the WASM wrapper keep the game as a base position (the
+// empty board or one loaded with "position board") plus the moves played
+// since, so whole positions can be set in one command and moves taken back.
+// ============================================================================
+
+#ifndef GAME_H
+#define GAME_H
+
+#include "board.h"
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct GameState {
+    Board base;                 // Start of the move history
+    std::vector<int> moves;     // Moves played from base
+    Board board;                // Current position (base + moves)
+    
+    // Empty board, no history
+    void reset();
+    
+    // Play a move; false if it is not legal
+    bool play(int move);
+    
+    // Undo the last n moves by replaying the rest; false if there are fewer
+    bool takeback(int n);
+    
+    // Apply the arguments of a takeback command: [n] (default 1, at least
+    // 1). Returns "" on success or an error message, in which case the
+    // state is unchanged.
+    std::string takeback(std::istringstream& args);
+    
+    // Apply the arguments of a position command:
+    //   startpos [moves i j ...]
+    //   board <225 cells> [side <b|w>] [moves i j ...]
+    // Cells as in Board::load. Returns "" on success or an error message,
+    // in which case the state is unchanged.
+    std::string set_position(std::istringstream& args);
+};
+
+#endif // GAME_H
@@ -0,0 +1,100 @@
+#include "gamerecord.h"
+#include <cmath>
+
+// ============================================================================
+// Little-endian field helpers
+// ============================================================================
+static inline void put_u8(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back((uint8_t)v);
+}
+
+static inline void put_u16(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back((uint8_t)v);
+    out.push_back((uint8_t)(v >> 8));
+}
+
+static inline void put_u32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; i++) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static inline uint32_t get_le(const uint8_t*& p, int bytes) {
+    uint32_t v = 0;
+    for (int i = 0; i < bytes; i++) v |= (uint32_t)p[i] << (8 * i);
+    p += bytes;
+    return v;
+}
+
+// ============================================================================
+// Encoding
+// ============================================================================
+void encode_record_header(std::vector<uint8_t>& out) {
+    out.insert(out.end(), {'G', 'M', 'K', 'R'});
+    put_u16(out, RECORD_VERSION);
+    put_u16(out, 0);
+}
+
+void encode_game_record(const GameRecord& rec, std::vector<uint8_t>& out) {
+    put_u32(out, rec.game_id);
+    put_u8(out, rec.result);
+    put_u8(out, rec.opening_plies);
+    put_u16(out, rec.moves.size());
+    for (const MoveRecord& m : rec.moves) {
+        double wr = m.winrate < 0 ? 0 : m.winrate > 1 ? 1 : m.winrate;
+        put_u8(out, m.move);
+        put_u16(out, (uint32_t)lround(wr * 65535));
+        put_u32(out, m.root_visits);
+        put_u32(out, m.best_visits);
+    }
+}
+
+// ============================================================================
+// Decoding
+// ============================================================================
+bool decode_record_header(const uint8_t*& p, const uint8_t* end) {
+    if (end - p < RECORD_HEADER_BYTES) return false;
+    if (p[0] != 'G' || p[1] != 'M' || p[2] != 'K' || p[3] != 'R') return false;
+    p += 4;
+    int version = get_le(p, 2);
+    get_le(p, 2);
+    return version == RECORD_VERSION;
+}
+
+bool decode_game_record(const uint8_t*& p, const uint8_t* end, GameRecord& rec) {
+    if (end - p < 8) return false;
+    const uint8_t* q = p;
+    rec.game_id = get_le(q, 4);
+    rec.result = get_le(q, 1);
+    rec.opening_plies = get_le(q, 1);
+    int count = get_le(q, 2);
+    if (end - q < (long)count * 11) return false;
+    
+    rec.moves.resize(count);
+    for (MoveRecord& m : rec.moves) {
+        m.move = get_le(q, 1);
+        m.winrate = get_le(q, 2) / 65535.0;
+        m.root_visits = get_le(q, 4);
+        m.best_visits = get_le(q, 4);
+    }
+    p = q;
+    return true;
+}
+
+bool read_record_file(const char* path, std::vector<GameRecord>& games) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return false;
+    std::vector<uint8_t> data;
+    uint8_t buf[1 << 16];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) data.insert(data.end(), buf, buf + n);
+    fclose(fp);
+    
+    const uint8_t* p = data.data();
+    const uint8_t* end = p + data.size();
+    if (!decode_record_header(p, end)) return false;
+    while (p < end) {
+        GameRecord rec;
+        if (!decode_game_record(p, end, rec)) return false;
+        games.push_back(rec);
+    }
+    return true;
+}
@@ -0,0 +1,55 @@
+// ============================================================================
+// DeepReaL Gomoku Engine v0 - Binary game records (selfplay output)
+//
+// File layout (all integers little-endian):
+//   header:  "GMKR"  uint16 version (=1)  uint16 reserved (=0)
+//   games, each:
+//     uint32 game_id
+//     uint8  result          0 = white win, 1 = black win, 2 = draw
+//     uint8  opening_plies   leading random (unsearched) moves
+//     uint16 move_count
+//     move_count x 11 bytes:
+//       uint8  move          board index 0-224
+//       uint16 winrate       root win rate for the side to move x 65535
+//       uint32 root_visits   0 = move was not searched
+//       uint32 best_visits   visits of the chosen move
+// ============================================================================
+
+#ifndef GAMERECORD_H
+#define GAMERECORD_H
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+constexpr int RECORD_VERSION = 1;
+constexpr int RECORD_HEADER_BYTES = 8;
+constexpr int RECORD_DRAW = 2;
+
+struct MoveRecord {
+    int move;
+    double winrate;         // Side to move, 0..1
+    uint32_t root_visits;
+    uint32_t best_visits;
+};
+
+struct GameRecord {
+    uint32_t game_id;
+    int result;             // 0 = white win, 1 = black win, RECORD_DRAW
+    int opening_plies;
+    std::vector<MoveRecord> moves;
+};
+
+// Append the file header / one game to 'out'
+void encode_record_header(std::vector<uint8_t>& out);
+void encode_game_record(const GameRecord& rec, std::vector<uint8_t>& out);
+
+// Parse from [p, end), advancing p. Return false on a bad header or a
+// truncated record.
+bool decode_record_header(const uint8_t*& p, const uint8_t* end);
+bool decode_game_record(const uint8_t*& p, const uint8_t* end, GameRecord& rec);
+
+// Read a whole record file; false if it can't be opened or is malformed
+bool read_record_file(const char* path, std::vector<GameRecord>& games);
+
+#endif // GAMERECORD_H
@@ -5,13 +5,106 @@
 #include "board.h"
 #include "search.h"
 #include "uci.h"
+#include "bench.h"
+#include "analyze.h"
+#include "server.h"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
-int main() {
+static std::atomic<bool> g_server_stop(false);
+
+static void stop_server(int) {
+    g_server_stop = true;
+}
+
+int main(int argc, char** argv) {
     // Initialize precomputed tables
     init_precompute();
     init_threat_tables();
     
+    // gomoku bench [iters]: run the benchmark and exit
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        int iters = argc > 2 ? atoi(argv[2]) : BENCH_ITERS;
+        run_bench(iters, [](const std::string& line) { std::cout << line << std::endl; });
+        return 0;
+    }
+    
+    // gomoku analyze FILE [--threads T] [--iters N] [--movetime MS] [--option NAME=VALUE]...
+    if (argc > 2 && strcmp(argv[1], "analyze") == 0) {
+        AnalyzeConfig cfg;
+        bool has_iters = false;
+        for (int i = 3; i + 1 < argc; i += 2) {
+            std::string arg = argv[i], val = argv[i + 1];
+            size_t eq = val.find('=');
+            if (arg == "--threads") cfg.threads = atoi(val.c_str());
+            else if (arg == "--iters") cfg.iters = atoi(val.c_str()), has_iters = true;
+            else if (arg == "--movetime") cfg.movetime_ms = atoi(val.c_str());
+            else if (arg == "--option" && eq != std::string::npos &&
+                     set_search_option(val.substr(0, eq), val.substr(eq + 1))) continue;
+            else {
+                fprintf(stderr, "error: invalid argument %s %s\n", arg.c_str(), val.c_str());
+                return 1;
+            }
+        }
+        if (cfg.movetime_ms > 0 && !has_iters) cfg.iters = 0;  // movetime alone
+        auto start = std::chrono::steady_clock::now();
+        long long count = run_analyze(argv[2], cfg, stdout);
+        if (count < 0) {
+            fprintf(stderr, "error: cannot read %s\n", argv[2]);
+            return 1;
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        fprintf(stderr, "analyzed %lld positions in %.1f s (%.1f positions/s)\n", count, secs,
+                secs > 0 ? count / secs : 0.0);
+        return 0;
+    }
+    
+    // gomoku serve [--socket PATH | --port N] [--workers W] [--queue Q]
+    //              [--iters N] [--movetime MS] [--deadline MS]
+    if (argc > 1 && strcmp(argv[1], "serve") == 0) {
+        ServerConfig cfg;
+        bool has_iters = false;
+        for (int i = 2; i < argc; i += 2) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                fprintf(stderr, "error: missing value for %s\n", arg.c_str());
+                return 1;
+            }
+            const char* val = argv[i + 1];
+            if (arg == "--socket") cfg.socket_path = val;
+            else if (arg == "--port") cfg.port = atoi(val);
+            else if (arg == "--workers") cfg.workers = atoi(val);
+            else if (arg == "--queue") cfg.queue_size = atoi(val);
+            else if (arg == "--iters") cfg.iters = atoi(val), has_iters = true;
+            else if (arg == "--movetime") cfg.movetime_ms = atoi(val);
+            else if (arg == "--deadline") cfg.deadline_ms = atoi(val);
+            else {
+                fprintf(stderr, "error: unknown option %s\n", arg.c_str());
+                return 1;
+            }
+        }
+        if (cfg.movetime_ms > 0 && !has_iters) cfg.iters = 0;
+        if (cfg.socket_path.empty() && cfg.port <= 0) {
+            fprintf(stderr, "error: serve needs --socket PATH or --port N\n");
+            return 1;
+        }
+        signal(SIGPIPE, SIG_IGN);
+        signal(SIGINT, stop_server);
+        signal(SIGTERM, stop_server);
+        if (run_server(cfg, &g_server_stop) != 0) {
+            fprintf(stderr, "error: cannot listen on %s\n",
+                    cfg.socket_path.empty() ? ("port " + std::to_string(cfg.port)).c_str()
+                                            : cfg.socket_path.c_str());
+            return 1;
+        }
+        return 0;
+    }
+    
     // Enter UCI loop
     uci_loop();
     
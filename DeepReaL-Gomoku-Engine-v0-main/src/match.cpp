@@ -0,0 +1,440 @@
+// ============================================================================
+// DeepReaL Gomoku Engine v0 - Engine-vs-engine match runner
+// Plays game pairs (same random opening, colours swapped) between two
+// engine configurations on a pool of threads and stops early on a
+// sequential probability ratio test. Each engine is either an in-process
+// configuration or an external binary speaking this engine's UCI text
+// protocol (init / update / go / bestmove).
+//
+//   match --engine1 SPEC --engine2 SPEC [--games N] [--threads T]
+//         [--opening PLIES] [--seed S] [--elo0 E] [--elo1 E]
+//         [--alpha A] [--beta B]
+//
+// SPEC is a comma-separated key=value list:
+//   name=LABEL      label in the report
+//   cmd=COMMAND     run COMMAND (via /bin/sh) instead of searching in-process
+//   iters=N         iterations per move (0 = only movetime)
+//   movetime=MS     time per move
+//   OPTION=VALUE    any setoption name (MCTS_C, ROLLOUT_DEPTH, ROLLOUTS, ...)
+// ============================================================================
+
+#include "board.h"
+#include "search.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+struct EngineSpec {
+    string name;
+    string cmd;                                 // Empty = in-process search
+    int iters = 10000;
+    int movetime_ms = 0;
+    SearchOptions options;                      // In-process engines
+    vector<pair<string, string>> uci_options;   // External engines (setoption)
+};
+
+struct MatchConfig {
+    EngineSpec engines[2];
+    int games = 1000;                           // Upper bound, rounded up to pairs
+    int threads = 0;                            // 0 = hardware concurrency
+    int opening_plies = 4;
+    uint64_t seed = ROLLOUT_SEED;
+    double elo0 = 0, elo1 = 5;                  // SPRT hypotheses H0 / H1
+    double alpha = 0.05, beta = 0.05;
+};
+
+static MatchConfig cfg;
+
+// ============================================================================
+// Engine spec parsing
+// ============================================================================
+static bool parse_spec(const string& text, EngineSpec& spec, const char* default_name) {
+    spec.name = default_name;
+    vector<pair<string, string>> options;
+    stringstream ss(text);
+    string item;
+    while (getline(ss, item, ',')) {
+        size_t eq = item.find('=');
+        if (eq == string::npos) {
+            fprintf(stderr, "error: expected key=value, got '%s'\n", item.c_str());
+            return false;
+        }
+        string key = item.substr(0, eq), value = item.substr(eq + 1);
+        if (key == "name") spec.name = value;
+        else if (key == "cmd") spec.cmd = value;
+        else if (key == "iters") spec.iters = atoi(value.c_str());
+        else if (key == "movetime") spec.movetime_ms = atoi(value.c_str());
+        else options.push_back({key, value});
+    }
+    for (auto& o : options) {
+        if (!spec.cmd.empty()) {
+            spec.uci_options.push_back(o);
+        } else if (!set_search_option(spec.options, o.first, o.second)) {
+            fprintf(stderr, "error: invalid option %s=%s\n", o.first.c_str(), o.second.c_str());
+            return false;
+        }
+    }
+    if (spec.iters <= 0 && spec.movetime_ms <= 0) {
+        fprintf(stderr, "error: %s needs iters or movetime\n", spec.name.c_str());
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// Players: one per engine per worker thread
+// ============================================================================
+struct Player {
+    const EngineSpec* spec;
+    pid_t pid = -1;                 // External engine process
+    FILE* to = nullptr;
+    FILE* from = nullptr;
+    size_t sent = 0;                // Moves of the current game already sent
+    long long iters = 0;            // Totals for the nps report
+    double ms = 0;
+};
+
+static bool read_line(Player& p, string& line) {
+    char* buf = nullptr;
+    size_t cap = 0;
+    ssize_t n = getline(&buf, &cap, p.from);
+    if (n > 0) line.assign(buf, buf[n - 1] == '\n' ? n - 1 : n);
+    free(buf);
+    return n > 0;
+}
+
+static void send_line(Player& p, const string& line) {
+    fprintf(p.to, "%s\n", line.c_str());
+    fflush(p.to);
+}
+
+// Read until a line starting with 'prefix'; false if the engine went away
+static bool expect(Player& p, const string& prefix, string& line) {
+    while (read_line(p, line)) {
+        if (line.compare(0, prefix.size(), prefix) == 0) return true;
+    }
+    return false;
+}
+
+static bool player_start(Player& p, const EngineSpec* spec) {
+    p.spec = spec;
+    if (spec->cmd.empty()) return true;
+
+    int in[2], out[2];
+    if (pipe2(in, O_CLOEXEC) != 0 || pipe2(out, O_CLOEXEC) != 0) return false;
+    p.pid = fork();
+    if (p.pid < 0) return false;
+    if (p.pid == 0) {
+        dup2(in[0], 0);
+        dup2(out[1], 1);
+        execl("/bin/sh", "sh", "-c", spec->cmd.c_str(), (char*)nullptr);
+        _exit(127);
+    }
+    close(in[0]);
+    close(out[1]);
+    p.to = fdopen(in[1], "w");
+    p.from = fdopen(out[0], "r");
+
+    string line;
+    for (auto& o : spec->uci_options) {
+        send_line(p, "setoption name " + o.first + " value " + o.second);
+        if (!read_line(p, line) || line != "ok") {
+            fprintf(stderr, "error: %s rejected option %s=%s\n", spec->name.c_str(),
+                    o.first.c_str(), o.second.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+static void player_stop(Player& p) {
+    if (p.pid < 0) return;
+    send_line(p, "quit");
+    fclose(p.to);
+    fclose(p.from);
+    waitpid(p.pid, nullptr, 0);
+    p.pid = -1;
+}
+
+static bool player_new_game(Player& p) {
+    p.sent = 0;
+    if (p.pid < 0) return true;
+    string line;
+    send_line(p, "init");
+    return expect(p, "ready", line);
+}
+
+// Best move for the position after 'moves'; -1 if the engine failed
+static int player_move(Player& p, const Board& board, const vector<int>& moves) {
+    const EngineSpec& spec = *p.spec;
+
+    if (p.pid < 0) {
+        // Both engines may share this thread, so the tree is never reused
+        SearchLimits limits;
+        limits.iters = spec.iters;
+        limits.movetime_ms = spec.movetime_ms;
+        limits.options = &spec.options;
+        limits.rng_stream = moves.size();
+        Board copy = board;
+        int move = getBest(copy, limits);
+        p.iters += search_stats.iterations;
+        p.ms += search_stats.total_ms;
+        return move;
+    }
+
+    string line;
+    for (; p.sent < moves.size(); p.sent++) {
+        send_line(p, "update " + to_string(moves[p.sent]));
+        if (!read_line(p, line) || line != "ok") return -1;
+    }
+    string go = "go";
+    if (spec.iters > 0) go += " iters " + to_string(spec.iters);
+    if (spec.movetime_ms > 0) go += " movetime " + to_string(spec.movetime_ms);
+    send_line(p, go);
+
+    // The last "info" line before "bestmove" covers the whole search
+    long long iters = 0, time_ms = 0;
+    while (read_line(p, line)) {
+        istringstream iss(line);
+        string tok;
+        iss >> tok;
+        if (tok == "bestmove") {
+            int move = -1;
+            iss >> move;
+            p.iters += iters;
+            p.ms += time_ms;
+            return move;
+        }
+        if (tok == "info") {
+            while (iss >> tok) {
+                if (tok == "iters") iss >> iters;
+                else if (tok == "time") iss >> time_ms;
+            }
+        }
+    }
+    return -1;
+}
+
+// ============================================================================
+// Results and SPRT
+// ============================================================================
+static mutex result_mutex;          // Guards the counters below
+static int wins = 0, losses = 0, draws = 0;   // From engine 1's point of view
+static long long total_iters[2] = {0, 0};
+static double total_ms[2] = {0, 0};
+static atomic<bool> stop_match(false);
+static atomic<int> next_pair(0);
+static const char* verdict = nullptr;
+
+static double elo_from_score(double s) {
+    s = min(max(s, 1e-6), 1 - 1e-6);
+    return -400.0 * log10(1.0 / s - 1.0);
+}
+
+static double score_from_elo(double elo) {
+    return 1.0 / (1.0 + pow(10.0, -elo / 400.0));
+}
+
+// Mean score and its per-game variance
+static void score_stats(double& mean, double& var) {
+    int n = wins + losses + draws;
+    mean = (wins + 0.5 * draws) / n;
+    var = (wins * pow(1 - mean, 2) + draws * pow(0.5 - mean, 2) + losses * pow(mean, 2)) / n;
+}
+
+// Generalised SPRT log-likelihood ratio (normal approximation on the
+// trinomial game scores) for H1: elo1 against H0: elo0
+static double sprt_llr() {
+    int n = wins + losses + draws;
+    if (n == 0) return 0;
+    double mean, var;
+    score_stats(mean, var);
+    if (var <= 0) return 0;
+    double s0 = score_from_elo(cfg.elo0), s1 = score_from_elo(cfg.elo1);
+    return n * (s1 - s0) * (2 * mean - s0 - s1) / (2 * var);
+}
+
+static void report(bool final) {
+    int n = wins + losses + draws;
+    double mean, var;
+    score_stats(mean, var);
+    double margin = 1.96 * sqrt(var / n);
+    double elo = elo_from_score(mean);
+    double err = (elo_from_score(mean + margin) - elo_from_score(mean - margin)) / 2;
+    double lower = log(cfg.beta / (1 - cfg.alpha)), upper = log((1 - cfg.beta) / cfg.alpha);
+
+    if (!final) {
+        fprintf(stderr, "games %d: +%d -%d =%d  score %.3f  elo %.1f +/- %.1f  LLR %.2f (%.2f, %.2f)\n",
+                n, wins, losses, draws, mean, elo, err, sprt_llr(), lower, upper);
+        return;
+    }
+
+    printf("%s vs %s: +%d -%d =%d (%d games)\n", cfg.engines[0].name.c_str(),
+           cfg.engines[1].name.c_str(), wins, losses, draws, n);
+    printf("Elo difference: %.1f +/- %.1f (95%%)\n", elo, err);
+    printf("SPRT [%.1f, %.1f]: LLR %.2f (%.2f, %.2f) %s\n", cfg.elo0, cfg.elo1, sprt_llr(),
+           lower, upper, verdict ? verdict : "inconclusive");
+    for (int e = 0; e < 2; e++) {
+        double nps = total_ms[e] > 0 ? total_iters[e] * 1000.0 / total_ms[e] : 0;
+        printf("%s: %.0f nps\n", cfg.engines[e].name.c_str(), nps);
+    }
+}
+
+// Record a finished game pair and check the SPRT bounds
+static void add_pair(const double score[2], Player players[2]) {
+    lock_guard<mutex> lock(result_mutex);
+    for (int g = 0; g < 2; g++) {
+        if (score[g] == 1) wins++;
+        else if (score[g] == 0) losses++;
+        else draws++;
+    }
+    for (int e = 0; e < 2; e++) {
+        total_iters[e] += players[e].iters;
+        total_ms[e] += players[e].ms;
+        players[e].iters = 0;
+        players[e].ms = 0;
+    }
+    report(false);
+
+    double llr = sprt_llr();
+    if (!verdict && llr >= log((1 - cfg.beta) / cfg.alpha)) verdict = "H1 accepted";
+    if (!verdict && llr <= log(cfg.beta / (1 - cfg.alpha))) verdict = "H0 accepted";
+    if (verdict) stop_match = true;
+}
+
+// ============================================================================
+// Games
+// ============================================================================
+// Play one game from 'opening'; engine 1 plays black unless 'swap'.
+// Returns engine 1's score. An engine that fails or plays an illegal move
+// loses the game.
+static double play_game(Player players[2], const Board& opening, const vector<int>& opening_moves,
+                        bool swap) {
+    Player* side_player[2] = {&players[swap ? 1 : 0], &players[swap ? 0 : 1]};
+    int engine1_side = swap ? 1 : 0;
+    for (int e = 0; e < 2; e++) {
+        if (!player_new_game(players[e])) return e == 0 ? 0.0 : 1.0;
+    }
+
+    Board board = opening;
+    vector<int> moves = opening_moves;
+    // nxt is empty before the first stone; engines then play the centre
+    while (!board.isTerminal() && (board.cnt == 0 || !board.nxt.empty())) {
+        int side = board.side();
+        int move = player_move(*side_player[side], board, moves);
+        if (move < 0 || move >= 225 || board.b[0].get(move) || board.b[1].get(move)) {
+            fprintf(stderr, "warning: %s failed or played illegal move %d\n",
+                    side_player[side]->spec->name.c_str(), move);
+            return side == engine1_side ? 0.0 : 1.0;
+        }
+        board.set(move);
+        moves.push_back(move);
+    }
+    if (!board.isTerminal()) return 0.5;
+    int winner = board.res == 1 ? 0 : 1;
+    return winner == engine1_side ? 1.0 : 0.0;
+}
+
+static void worker() {
+    Player players[2];
+    bool ok = player_start(players[0], &cfg.engines[0]) && player_start(players[1], &cfg.engines[1]);
+
+    int pair;
+    while (ok && !stop_match && (pair = next_pair++) < (cfg.games + 1) / 2) {
+        Rng rng;
+        rng.seed(cfg.seed, pair);
+        Board opening;
+        opening.init();
+        vector<int> moves;
+        random_opening(opening, rng, cfg.opening_plies, moves);
+
+        double score[2];
+        score[0] = play_game(players, opening, moves, false);
+        score[1] = play_game(players, opening, moves, true);
+        add_pair(score, players);
+    }
+    if (!ok) stop_match = true;
+    player_stop(players[0]);
+    player_stop(players[1]);
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "usage: %s --engine1 SPEC --engine2 SPEC [--games N] [--threads T]\n"
+            "          [--opening PLIES] [--seed S] [--elo0 E] [--elo1 E] [--alpha A] [--beta B]\n"
+            "SPEC: key=value[,key=value...] with keys name, cmd, iters, movetime\n"
+            "      or any setoption name (MCTS_C, ROLLOUT_DEPTH, ROLLOUTS, RAVE, ...)\n", prog);
+}
+
+int main(int argc, char** argv) {
+    string specs[2];
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        const char* val = argv[++i];
+        if (arg == "--engine1") specs[0] = val;
+        else if (arg == "--engine2") specs[1] = val;
+        else if (arg == "--games") cfg.games = atoi(val);
+        else if (arg == "--threads") cfg.threads = atoi(val);
+        else if (arg == "--opening") cfg.opening_plies = atoi(val);
+        else if (arg == "--seed") cfg.seed = strtoull(val, nullptr, 10);
+        else if (arg == "--elo0") cfg.elo0 = atof(val);
+        else if (arg == "--elo1") cfg.elo1 = atof(val);
+        else if (arg == "--alpha") cfg.alpha = atof(val);
+        else if (arg == "--beta") cfg.beta = atof(val);
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (specs[0].empty() || specs[1].empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (cfg.opening_plies < 0 || cfg.opening_plies > 225) {
+        fprintf(stderr, "error: --opening must be 0-225\n");
+        return 1;
+    }
+    if (!parse_spec(specs[0], cfg.engines[0], "engine1") ||
+        !parse_spec(specs[1], cfg.engines[1], "engine2")) {
+        return 1;
+    }
+    if (cfg.threads <= 0) cfg.threads = max(1u, thread::hardware_concurrency());
+    cfg.threads = min(cfg.threads, max(1, (cfg.games + 1) / 2));
+
+    signal(SIGPIPE, SIG_IGN);  // An external engine exiting must not kill the match
+    init_precompute();
+    init_threat_tables();
+
+    fprintf(stderr, "match: %s vs %s, up to %d games, %d threads\n",
+            cfg.engines[0].name.c_str(), cfg.engines[1].name.c_str(), cfg.games, cfg.threads);
+    vector<thread> pool;
+    for (int t = 0; t < cfg.threads; t++) pool.emplace_back(worker);
+    for (thread& t : pool) t.join();
+
+    if (wins + losses + draws == 0) {
+        fprintf(stderr, "error: no games completed\n");
+        return 1;
+    }
+    report(true);
+    return 0;
+}
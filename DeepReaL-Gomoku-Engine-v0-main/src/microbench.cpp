@@ -0,0 +1,255 @@
+// ============================================================================
+// DeepReaL Gomoku Engine v0 - Microbenchmarks (make bench)
+// Times the hot primitives in batches: warmup samples are discarded, then
+// the per-operation time of each repetition is collected and summarised as
+// min / p10 / median / p90 / max. A table goes to stderr and a JSON report
+// to stdout, so runs on two commits can be diffed directly.
+// ============================================================================
+
+#include "board.h"
+#include "search.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+constexpr int DEFAULT_REPS = 31;    // Measured samples per case
+constexpr int WARMUP_REPS = 5;      // Discarded samples per case
+constexpr int DFS_TREE_ITERS = 1000; // Tree size before timing dfs
+
+static volatile uint64_t sink;      // Keeps results observable
+
+struct CaseResult {
+    string name;
+    int batch;                      // Operations per sample
+    double min, p10, median, p90, max;  // ns per operation
+};
+
+static int reps = DEFAULT_REPS;
+static const char* filter = nullptr;
+static vector<CaseResult> results;
+
+static double percentile(const vector<double>& sorted, double p) {
+    double pos = p * (sorted.size() - 1);
+    size_t lo = (size_t)pos;
+    size_t hi = min(lo + 1, sorted.size() - 1);
+    return sorted[lo] + (sorted[hi] - sorted[lo]) * (pos - lo);
+}
+
+// Run 'op' batch times per sample. 'setup' (optional) runs before each
+// sample and is not timed.
+static void bench_case(const string& name, int batch, const function<void()>& op,
+                       const function<void()>& setup = nullptr) {
+    if (filter && name.find(filter) == string::npos) return;
+    
+    vector<double> samples;
+    for (int r = 0; r < WARMUP_REPS + reps; r++) {
+        if (setup) setup();
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < batch; i++) op();
+        auto end = chrono::steady_clock::now();
+        if (r < WARMUP_REPS) continue;
+        samples.push_back(chrono::duration<double, nano>(end - start).count() / batch);
+    }
+    sort(samples.begin(), samples.end());
+    
+    CaseResult res{name, batch, samples.front(), percentile(samples, 0.1),
+                   percentile(samples, 0.5), percentile(samples, 0.9), samples.back()};
+    fprintf(stderr, "%-28s %10.1f %10.1f %10.1f %10.1f %10.1f\n", name.c_str(),
+            res.min, res.p10, res.median, res.p90, res.max);
+    results.push_back(res);
+}
+
+// ============================================================================
+// Positions
+// ============================================================================
+static Board make_board(const vector<int>& moves) {
+    Board board;
+    board.init();
+    for (int m : moves) board.set(m);
+    return board;
+}
+
+// Fixed pseudo-random position with 'stones' stones and no threats (live
+// three or better) for either side, so searches on it are not forced
+static Board quiet_position(int stones, uint64_t seed) {
+    int moves[225];
+    int count;
+    Board board;
+    board.init();
+    board.set(112);
+    while (board.cnt < stones) {
+        seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+        lbit256 cand = board.nxt;
+        int target = (int)(seed % cand.popcount());
+        int move = -1;
+        for (int i = 0; i <= target; i++) move = cand.popbit();
+        Board next = board;
+        next.set(move);
+        if (scan_all_threats(next, 0, moves, count, true) == THREAT_NONE &&
+            scan_all_threats(next, 1, moves, count, true) == THREAT_NONE) {
+            board = next;
+        }
+    }
+    return board;
+}
+
+struct Phase {
+    const char* name;
+    Board board;
+};
+
+// ============================================================================
+// Cases
+// ============================================================================
+static void bench_lbit256() {
+    lbit256 a(0x123456789abcdef0ULL, 0x0fedcba987654321ULL, 0xaaaa5555aaaa5555ULL, 0x1ffffffffULL);
+    lbit256 b(0x5555aaaa5555aaaaULL, 0xf0f0f0f0f0f0f0f0ULL, 0x0123456789abcdefULL, 0x3ULL);
+    
+    bench_case("lbit256_and_or_not", 100000, [&]() {
+        a = (a | b) & ~(a & b);
+        b.d[0] += 1;
+        sink = a.d[0];
+    });
+    bench_case("lbit256_popcount", 100000, [&]() {
+        b.d[1] += 1;
+        sink = b.popcount();
+    });
+    bench_case("lbit256_popbit_all", 10000, [&]() {
+        lbit256 m = board_mask;
+        int s = 0;
+        while (!m.empty()) s += m.popbit();
+        sink = s;
+    });
+    bench_case("lbit256_set_get", 100000, [&]() {
+        static int idx = 0;
+        idx = (idx + 37) % 225;
+        a.set(idx);
+        sink = a.get((idx + 1) % 225);
+        a.clear(idx);
+    });
+}
+
+static void bench_board(const vector<int>& game) {
+    Board board;
+    bench_case("board_init", 100000, [&]() {
+        board.init();
+        sink = board.cnt;
+    });
+    
+    Board start = make_board({});
+    size_t k = 0;
+    bench_case("board_set", 100000, [&]() {
+        if (k == game.size()) {
+            board = start;
+            k = 0;
+        }
+        board.set(game[k++]);
+        sink = board.res;
+    }, [&]() { board = start; k = 0; });
+}
+
+static void bench_threats(const vector<Phase>& phases) {
+    int moves[225];
+    int count;
+    for (const Phase& ph : phases) {
+        const Board& board = ph.board;
+        int side = board.side();
+        bench_case(string("scan_threats_") + ph.name, 10000, [&]() {
+            int lvl = scan_threats(board, board.last_move, 1 - side, moves, count, false);
+            lvl += scan_threats(board, board.last_move, side, moves, count, true);
+            sink = lvl + count;
+        });
+        bench_case(string("scan_all_threats_") + ph.name, 2000, [&]() {
+            int lvl = scan_all_threats(board, 1 - side, moves, count, false);
+            lvl += scan_all_threats(board, side, moves, count, true);
+            sink = lvl + count;
+        });
+    }
+}
+
+static void bench_rollout(const vector<Phase>& phases) {
+    for (const Phase& ph : phases) {
+        double sum = 0;
+        bench_case(string("rollout_") + ph.name, 2000, [&]() {
+            sum += rollout(ph.board);
+            sink = (uint64_t)sum;
+        }, []() { rollout_rng.seed(ROLLOUT_SEED); });
+        // Cost per rollout when ROLLOUT_LANES play in lock-step
+        bench_case(string("rollout_batch8_") + ph.name, 250, [&]() {
+            sum += rollout_batch(ph.board, ROLLOUT_LANES);
+            sink = (uint64_t)sum;
+        }, []() { rollout_rng.seed(ROLLOUT_SEED); });
+    }
+}
+
+// One MCTS iteration (dfs from the root) on a tree grown to DFS_TREE_ITERS
+static void bench_dfs(const vector<Phase>& phases) {
+    for (const Phase& ph : phases) {
+        Board board = ph.board;
+        bench_case(string("dfs_iteration_") + ph.name, 500, [&]() {
+            Board copy = board;
+            sink = (uint64_t)(dfs(tree_root, board.last_move, -1, copy) * 2);
+        }, [&]() {
+            getBest(board, DFS_TREE_ITERS);
+        });
+    }
+}
+
+// ============================================================================
+// Report
+// ============================================================================
+static void print_json() {
+    printf("{\n  \"reps\": %d,\n  \"warmup\": %d,\n  \"unit\": \"ns/op\",\n  \"cases\": [\n",
+           reps, WARMUP_REPS);
+    for (size_t i = 0; i < results.size(); i++) {
+        const CaseResult& r = results[i];
+        printf("    {\"name\": \"%s\", \"batch\": %d, \"min\": %.2f, \"p10\": %.2f, "
+               "\"median\": %.2f, \"p90\": %.2f, \"max\": %.2f}%s\n",
+               r.name.c_str(), r.batch, r.min, r.p10, r.median, r.p90, r.max,
+               i + 1 < results.size() ? "," : "");
+    }
+    printf("  ]\n}\n");
+}
+
+int main(int argc, char** argv) {
+    // microbench [--reps N] [--filter SUBSTR]
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) {
+            reps = max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--reps N] [--filter SUBSTR]\n", argv[0]);
+            return 1;
+        }
+    }
+    
+    init_precompute();
+    init_threat_tables();
+    
+    // Opening of the test_performance game (decided at move 14)
+    vector<int> game = {112, 113, 126, 98, 96, 128, 110, 82, 142, 83, 125, 99, 81};
+    vector<Phase> phases = {
+        {"opening", make_board({112, 113, 126, 98})},
+        {"middle", quiet_position(20, 0x9e3779b97f4a7c15ULL)},
+        {"late", quiet_position(50, 0x9e3779b97f4a7c15ULL)},
+    };
+    
+    fprintf(stderr, "%-28s %10s %10s %10s %10s %10s   (ns/op)\n",
+            "case", "min", "p10", "median", "p90", "max");
+    bench_lbit256();
+    bench_board(game);
+    bench_threats(phases);
+    bench_rollout(phases);
+    bench_dfs(phases);
+    
+    print_json();
+    return 0;
+}
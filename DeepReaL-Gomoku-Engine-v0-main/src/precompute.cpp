@@ -13,6 +13,8 @@ int diag2_idy[225];
 lbit256 f[225];
 lbit256 cheb2[225];
 bool win_table[1 << 15];
+uint8_t pattern_info[1 << 14];
+int sym_table[NUM_SYMMETRIES][225];
 lbit256 board_mask;
 
 // ============================================================================
@@ -86,4 +88,30 @@ void init_precompute() {
             }
         }
     }
+
+    // Initialize pattern_info - window cells 1-5, neighbours 0 and 6
+    for (int idx = 0; idx < (1 << 14); idx++) {
+        int own_bits = idx & 127, opp_bits = idx >> 7;
+        int own = 0, blocked = 0;
+        for (int j = 1; j <= 5; j++) {
+            if ((opp_bits >> j) & 1) blocked = 8;  // Opponent stone or off the board
+            else if ((own_bits >> j) & 1) own++;
+        }
+        int open = ((own_bits | opp_bits) & 0x41) == 0 ? 16 : 0;
+        pattern_info[idx] = (uint8_t)(own | blocked | open);
+    }
+
+    // Initialize sym_table - index permutations for the 8 board symmetries
+    for (int i = 0; i < 225; i++) {
+        int r = row_id[i];
+        int c = col_id[i];
+        sym_table[0][i] = r * 15 + c;                // identity
+        sym_table[1][i] = c * 15 + (14 - r);         // rotate 90
+        sym_table[2][i] = (14 - r) * 15 + (14 - c);  // rotate 180
+        sym_table[3][i] = (14 - c) * 15 + r;         // rotate 270
+        sym_table[4][i] = r * 15 + (14 - c);         // mirror left-right
+        sym_table[5][i] = (14 - r) * 15 + c;         // mirror top-bottom
+        sym_table[6][i] = c * 15 + r;                // main diagonal
+        sym_table[7][i] = (14 - c) * 15 + (14 - r);  // anti-diagonal
+    }
 }
@@ -0,0 +1,83 @@
+// ============================================================================
+// DeepReaL Gomoku Engine v0 - Hot-path call/cycle counters
+// ============================================================================
+
+#include "profile.h"
+#include <sstream>
+
+#ifdef GOMOKU_PROFILE
+
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+static const char* const profile_names[PROF_COUNT] = {
+    "Board::set",
+    "scan_threats",
+    "scan_all_threats",
+    "opponent_blocks_pattern",
+    "rollout",
+    "ucb",
+    "alloc_node"
+};
+
+thread_local ProfileCounter* profile_block = nullptr;
+
+static std::mutex profile_mutex;
+static std::vector<ProfileCounter*> profile_blocks;
+
+ProfileCounter* profile_register() {
+    ProfileCounter* block = new ProfileCounter[PROF_COUNT]();
+    std::lock_guard<std::mutex> lock(profile_mutex);
+    profile_blocks.push_back(block);
+    return block;
+}
+
+std::string profile_report() {
+    ProfileCounter total[PROF_COUNT];
+    memset(total, 0, sizeof(total));
+    {
+        // Counters of running threads are read without synchronisation;
+        // report after the search for exact numbers
+        std::lock_guard<std::mutex> lock(profile_mutex);
+        for (ProfileCounter* block : profile_blocks) {
+            for (int i = 0; i < PROF_COUNT; i++) {
+                total[i].calls += block[i].calls;
+                total[i].ticks += block[i].ticks;
+            }
+        }
+    }
+    
+#if defined(__x86_64__) || defined(__i386__)
+    const char* unit = "cycles";
+#else
+    const char* unit = "ns";
+#endif
+    std::ostringstream oss;
+    oss.setf(std::ios::fixed);
+    oss.precision(1);
+    for (int i = 0; i < PROF_COUNT; i++) {
+        double avg = total[i].calls ? (double)total[i].ticks / total[i].calls : 0.0;
+        oss << (i ? "\n" : "") << "profile " << profile_names[i]
+            << " calls " << total[i].calls << " " << unit << " " << total[i].ticks
+            << " avg " << avg;
+    }
+    return oss.str();
+}
+
+void profile_reset() {
+    std::lock_guard<std::mutex> lock(profile_mutex);
+    for (ProfileCounter* block : profile_blocks) {
+        memset(block, 0, sizeof(ProfileCounter) * PROF_COUNT);
+    }
+}
+
+#else
+
+std::string profile_report() {
+    return "profile disabled (build with make profile)";
+}
+
+void profile_reset() {}
+
+#endif // GOMOKU_PROFILE
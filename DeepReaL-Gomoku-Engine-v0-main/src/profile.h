@@ -0,0 +1,84 @@
+// ============================================================================
+// DeepReaL Gomoku Engine v0 - Hot-path call/cycle counters
+// Compiled in only with -DGOMOKU_PROFILE (make profile); otherwise
+// PROFILE_SCOPE expands to nothing.
+// ============================================================================
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <cstdint>
+#include <string>
+
+enum ProfileId {
+    PROF_BOARD_SET,
+    PROF_SCAN_THREATS,
+    PROF_SCAN_ALL_THREATS,
+    PROF_OPPONENT_BLOCKS,
+    PROF_ROLLOUT,
+    PROF_UCB,
+    PROF_ALLOC_NODE,
+    PROF_COUNT
+};
+
+#ifdef GOMOKU_PROFILE
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+struct ProfileCounter {
+    uint64_t calls;
+    uint64_t ticks;  // Inclusive of nested scopes
+};
+
+// Per-thread counter block, registered on first use so reports can sum
+// over all threads (including ones that have exited)
+extern thread_local ProfileCounter* profile_block;
+ProfileCounter* profile_register();
+
+// rdtsc cycles on x86, nanoseconds elsewhere
+static inline uint64_t profile_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+struct ProfileScope {
+    ProfileCounter* counter;
+    uint64_t start;
+    
+    inline explicit ProfileScope(ProfileId id) {
+        if (!profile_block) profile_block = profile_register();
+        counter = &profile_block[id];
+        start = profile_ticks();
+    }
+    inline ~ProfileScope() {
+        counter->ticks += profile_ticks() - start;
+        counter->calls++;
+    }
+};
+
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+#define PROFILE_SCOPE(id) ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(id)
+
+#else
+
+#define PROFILE_SCOPE(id) ((void)0)
+
+#endif // GOMOKU_PROFILE
+
+// Counters summed over all threads, one line per function
+std::string profile_report();
+
+// Zero all counters
+void profile_reset();
+
+#endif // PROFILE_H
@@ -0,0 +1,200 @@
+// ============================================================================
+// DeepReaL Gomoku Engine v0 - Batched rollouts
+// Plays up to ROLLOUT_LANES random games from one position in lock-step.
+// Each lane's bitboards and line masks are stored structure-of-arrays
+// (innermost index = lane), so the per-step work is a set of short
+// independent loops over lanes: move selection, line-mask updates and
+// win_table lookups for different lanes overlap instead of forming one
+// long dependency chain, and the nxt update is a plain lane loop the
+// compiler can vectorise. Each lane also keeps its legal moves as a list,
+// so picking a random move is O(1) instead of rollout()'s bit walk.
+// ============================================================================
+
+#include "search.h"
+#include "profile.h"
+#include <algorithm>
+#include <cstring>
+
+constexpr int L = ROLLOUT_LANES;
+
+struct LaneBoards {
+    uint64_t stones[2][4][L];
+    uint64_t nxt[4][L];
+    int row[2][15][L];
+    int col[2][15][L];
+    int diag1[2][29][L];
+    int diag2[2][29][L];
+    // Legal moves of each lane as an unordered list (swap-remove)
+    uint8_t moves[L][256];
+    int count[L];
+};
+
+// Broadcast 'board' into every lane
+static void load_lanes(LaneBoards& lb, const Board& board) {
+    for (int w = 0; w < 4; w++) {
+        for (int l = 0; l < L; l++) {
+            lb.stones[0][w][l] = board.b[0].d[w];
+            lb.stones[1][w][l] = board.b[1].d[w];
+            lb.nxt[w][l] = board.nxt.d[w];
+        }
+    }
+    for (int s = 0; s < 2; s++) {
+        for (int i = 0; i < 15; i++) {
+            for (int l = 0; l < L; l++) {
+                lb.row[s][i][l] = board.row[s][i];
+                lb.col[s][i][l] = board.col[s][i];
+            }
+        }
+        for (int i = 0; i < 29; i++) {
+            for (int l = 0; l < L; l++) {
+                lb.diag1[s][i][l] = board.diag1[s][i];
+                lb.diag2[s][i][l] = board.diag2[s][i];
+            }
+        }
+    }
+    
+    lbit256 nxt = board.nxt;
+    int n = 0;
+    while (!nxt.empty()) {
+        lb.moves[0][n++] = nxt.popbit();
+    }
+    for (int l = 0; l < L; l++) {
+        if (l > 0) memcpy(lb.moves[l], lb.moves[0], n);
+        lb.count[l] = n;
+    }
+}
+
+static inline void record_rollout(int depth, int outcome) {
+    search_stats.rollouts++;
+    search_stats.rollout_length[std::min(depth / 10, STATS_ROLLOUT_BUCKETS - 1)]++;
+    search_stats.rollout_results[outcome]++;
+}
+
+// Evaluate lane l at the cutoff: its line masks are copied into a board
+// whose pattern counts are taken from scratch
+static double evaluate_lane(const LaneBoards& lb, int l, int cnt) {
+    Board leaf;
+    leaf.init();
+    for (int s = 0; s < 2; s++) {
+        for (int i = 0; i < 15; i++) {
+            leaf.row[s][i] = lb.row[s][i][l];
+            leaf.col[s][i] = lb.col[s][i][l];
+        }
+        for (int i = 0; i < 29; i++) {
+            leaf.diag1[s][i] = lb.diag1[s][i][l];
+            leaf.diag2[s][i] = lb.diag2[s][i][l];
+        }
+    }
+    leaf.cnt = cnt;
+    leaf.enable_patterns();
+    return evaluate(leaf);
+}
+
+double rollout_batch(const Board& board, int lanes, int depth_limit, lbit256 (*played)[2], bool eval_cutoff,
+                     int* lane_wins) {
+    PROFILE_SCOPE(PROF_ROLLOUT);
+    lanes = std::max(1, std::min(lanes, L));
+    if (played) {
+        for (int l = 0; l < lanes; l++) played[l][0] = played[l][1] = lbit256();
+    }
+    
+    if (board.isTerminal()) {
+        for (int l = 0; l < lanes; l++) {
+            record_rollout(0, board.res);
+            if (lane_wins) lane_wins[l] = 2 * board.res;
+        }
+        return board.res;
+    }
+    
+    static thread_local LaneBoards lb;
+    load_lanes(lb, board);
+    Rng& rng = rollout_rng;
+    
+    bool active[L];
+    for (int l = 0; l < L; l++) active[l] = l < lanes;
+    int n_active = lanes;
+    int wins[L] = {};  // Lane results, black's perspective, x2
+    int side = board.side();
+    int depth = 0;
+    
+    while (n_active > 0 && depth < depth_limit) {
+        // Pick a uniformly random legal move per lane and take it off the list
+        int move[L];
+        for (int l = 0; l < L; l++) {
+            move[l] = -1;
+            if (!active[l]) continue;
+            int n = lb.count[l];
+            if (n == 0) {
+                wins[l] = 1;  // Draw
+                record_rollout(depth, ROLLOUT_DRAW);
+                active[l] = false;
+                n_active--;
+                continue;
+            }
+            int k = (int)(rng.next() % n);
+            move[l] = lb.moves[l][k];
+            lb.moves[l][k] = lb.moves[l][n - 1];
+            lb.count[l] = n - 1;
+        }
+        
+        // Stones and line masks of the side to move; win check
+        for (int l = 0; l < L; l++) {
+            int m = move[l];
+            if (m < 0) continue;
+            int r = row_id[m], c = col_id[m];
+            int d1 = diag1_idx[m], d2 = diag2_idx[m];
+            lb.stones[side][m >> 6][l] |= 1ULL << (m & 63);
+            int rm = lb.row[side][r][l] |= 1 << c;
+            int cm = lb.col[side][c][l] |= 1 << r;
+            int d1m = lb.diag1[side][d1][l] |= 1 << diag1_idy[m];
+            int d2m = lb.diag2[side][d2][l] |= 1 << diag2_idy[m];
+            if (played) played[l][side].set(m);
+            if (win_table[rm] | win_table[cm] | win_table[d1m] | win_table[d2m]) {
+                wins[l] = side == 0 ? 2 : 0;
+                record_rollout(depth + 1, side == 0 ? ROLLOUT_BLACK_WIN : ROLLOUT_WHITE_WIN);
+                active[l] = false;
+                n_active--;
+            }
+        }
+        
+        // Legal-move sets: the Chebyshev-2 neighbourhood squares that are
+        // new (not legal yet, not occupied) join nxt and the move list
+        uint64_t added[4][L];
+        for (int w = 0; w < 4; w++) {
+            for (int l = 0; l < L; l++) {
+                uint64_t keep = move[l] >= 0 ? ~0ULL : 0;
+                uint64_t near = cheb2[move[l] >= 0 ? move[l] : 0].d[w] & keep;
+                uint64_t used = lb.nxt[w][l] | lb.stones[0][w][l] | lb.stones[1][w][l];
+                added[w][l] = near & ~used & board_mask.d[w];
+                lb.nxt[w][l] |= added[w][l];
+            }
+        }
+        for (int l = 0; l < L; l++) {
+            if (!active[l]) continue;
+            int n = lb.count[l];
+            for (int w = 0; w < 4; w++) {
+                uint64_t a = added[w][l];
+                while (a) {
+                    lb.moves[l][n++] = w * 64 + __builtin_ctzll(a);
+                    a &= a - 1;
+                }
+            }
+            lb.count[l] = n;
+        }
+        
+        side ^= 1;
+        depth++;
+    }
+    
+    // Lanes still running hit the depth limit
+    int half_wins = 0;
+    for (int l = 0; l < lanes; l++) {
+        if (active[l]) {
+            wins[l] = eval_cutoff ? (int)(2 * sample_half(evaluate_lane(lb, l, board.cnt + depth), rng)) : 1;
+            record_rollout(depth, ROLLOUT_CUTOFF);
+        }
+        half_wins += wins[l];
+        if (lane_wins) lane_wins[l] = wins[l];
+    }
+    return half_wins / (2.0 * lanes);
+}
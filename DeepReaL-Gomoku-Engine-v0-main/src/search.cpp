@@ -1,26 +1,59 @@
 #include "search.h"
+#include "profile.h"
 #include <cstring>
+#include <cstdlib>
+#include <cstdio>
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <random>
-
-// Fast xorshift64* RNG for rollouts
-static inline uint64_t xorshift64(uint64_t& state) {
-    state ^= state >> 12;
-    state ^= state << 25;
-    state ^= state >> 27;
-    return state * 0x2545F4914F6CDD1DULL;
-}
+#include <sstream>
+#include <thread>
 
 // Forward declaration
 static bool opponent_blocks_pattern(int player_mask, int opp_mask, int p);
 
+// Monotonic time for phase statistics
+static inline long long now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 // ============================================================================
 // Global tables and node pool
 // ============================================================================
 int8_t threat_table[1 << 15][15];
 int8_t winning_table[1 << 15][15];
-Node nodes[MAX_NODES];
-int node_count = 0;
+SearchOptions search_options;
+
+// Options of the search running on this thread (copied by getBest)
+static thread_local SearchOptions opt;
+
+// Per-thread search state (see search.h)
+thread_local Node* nodes = nullptr;
+thread_local int node_count = 0;
+thread_local int node_capacity = 0;
+thread_local SearchStats search_stats;
+thread_local int tree_root = -1;
+thread_local Board tree_board;
+static thread_local std::unique_ptr<Node[]> node_pool;  // Owns nodes
+
+// Widening order lists, ORDER_LIST_MAX moves at most per node
+static thread_local uint8_t* move_order_pool = nullptr;
+static thread_local std::unique_ptr<uint8_t[]> order_pool;  // Owns move_order_pool
+static thread_local int move_order_count = 0;
+static thread_local int move_order_capacity = 0;
+
+// Moves played by each side after the current node in this iteration (RAVE).
+// A batched rollout keeps each lane's moves and result apart: amaf_played
+// then holds the tree moves only, and amaf_lanes > 0 lanes follow.
+static thread_local lbit256 amaf_played[2];
+static thread_local int amaf_lanes = 0;
+static thread_local lbit256 amaf_lane_played[ROLLOUT_LANES][2];
+static thread_local lbit256 amaf_lane_union[2];     // Of all lanes, per side
+static thread_local int amaf_lane_wins[ROLLOUT_LANES];  // Black's, x2
 
 // ============================================================================
 // Threat table initialization
@@ -279,36 +312,172 @@ void init_threat_tables() {
     }
 }
 
+// ============================================================================
+// Runtime options
+// ============================================================================
+static bool parse_bool(const std::string& value, bool& out) {
+    if (value == "true" || value == "1" || value == "on") { out = true; return true; }
+    if (value == "false" || value == "0" || value == "off") { out = false; return true; }
+    return false;
+}
+
+bool set_search_option(SearchOptions& opts, const std::string& name, const std::string& value) {
+    if (name == "RAVE") {
+        return parse_bool(value, opts.rave);
+    }
+    if (name == "RAVE_K") {
+        double k = atof(value.c_str());
+        if (k <= 0) return false;
+        opts.rave_k = k;
+        return true;
+    }
+    if (name == "SEED") {
+        char* end;
+        unsigned long long seed = strtoull(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0') return false;
+        opts.seed = seed;
+        return true;
+    }
+    if (name == "ROLLOUTS") {
+        int n = atoi(value.c_str());
+        if (n < 1 || n > ROLLOUT_LANES) return false;
+        opts.rollouts = n;
+        return true;
+    }
+    if (name == "MCTS_C") {
+        double c = atof(value.c_str());
+        if (c <= 0) return false;
+        opts.c = c;
+        return true;
+    }
+    if (name == "ROLLOUT_DEPTH") {
+        int d = atoi(value.c_str());
+        if (d < 1 || d > 225) return false;
+        opts.rollout_depth = d;
+        return true;
+    }
+    if (name == "NODES") {
+        int n = atoi(value.c_str());
+        if (n < MIN_NODE_BUDGET || n > MAX_NODE_BUDGET) return false;
+        opts.nodes = n;
+        return true;
+    }
+    if (name == "ROLLOUT_EVAL") {
+        int d = atoi(value.c_str());
+        if (d < 0 || d > 225 || value.empty()) return false;
+        opts.rollout_eval = d;
+        return true;
+    }
+    if (name == "MultiPV") {
+        int k = atoi(value.c_str());
+        if (k < 1 || k > 225) return false;
+        opts.multipv = k;
+        return true;
+    }
+    if (name == "Threads") {
+        int n = atoi(value.c_str());
+        if (n < 1 || n > MAX_SEARCH_THREADS) return false;
+        opts.threads = n;
+        return true;
+    }
+    return false;
+}
+
+bool set_search_option(const std::string& name, const std::string& value) {
+    return set_search_option(search_options, name, value);
+}
+
 // ============================================================================
 // Node pool management
 // ============================================================================
 void reset_nodes() {
+    if (node_capacity != opt.nodes) {
+        // Uninitialised storage: pages are committed as nodes are used
+        node_pool.reset();
+        order_pool.reset();
+        node_capacity = opt.nodes;
+        node_pool.reset(new Node[node_capacity]);
+        nodes = node_pool.get();
+        move_order_capacity = (int)((long long)node_capacity * MAX_ORDER_BYTES / MAX_NODES);
+        order_pool.reset(new uint8_t[move_order_capacity]);
+        move_order_pool = order_pool.get();
+        tree_root = -1;
+    }
     node_count = 0;
+    move_order_count = 0;
 }
 
 int alloc_node() {
-    if (node_count >= MAX_NODES) {
+    PROFILE_SCOPE(PROF_ALLOC_NODE);
+    if (node_count >= node_capacity) {
         return -1;  // Out of nodes
     }
     int id = node_count++;
     nodes[id].init();
+    search_stats.nodes_allocated++;
     return id;
 }
 
 // ============================================================================
 // Rollout - random playout until terminal or max depth
 // ============================================================================
-double rollout(Board board, int depth_limit) {
-    static uint64_t rng_state = 12345678901234567ULL;
+thread_local Rng rollout_rng = {ROLLOUT_SEED};
+
+static inline uint64_t splitmix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+void Rng::seed(uint64_t seed, uint64_t stream) {
+    state = splitmix64(seed ^ splitmix64(stream));
+    if (state == 0) state = ROLLOUT_SEED;  // xorshift state must be non-zero
+}
+
+// ============================================================================
+// Static evaluation
+// ============================================================================
+double evaluate(const Board& board) {
+    if (board.isTerminal()) return board.res;
+    int side = board.side();
+    if (board.pattern_count(side, PAT_FOUR) + board.pattern_count(side, PAT_OPEN_FOUR) > 0) {
+        return side == 0 ? 1.0 : 0.0;  // Five next move
+    }
+    
+    double score = 0;
+    for (int t = PAT_TWO; t < PATTERN_TYPES; t++) {
+        score += EVAL_WEIGHTS[t] * (EVAL_TEMPO * board.pattern_count(side, t) - board.pattern_count(1 - side, t));
+    }
+    double p = 1.0 / (1.0 + exp(-score / EVAL_SCALE));  // Side to move
+    return side == 0 ? p : 1.0 - p;
+}
+
+double sample_half(double p, Rng& rng) {
+    double x = 2.0 * p;
+    int h = (int)x;
+    if ((rng.next() >> 11) * 0x1.0p-53 < x - h) h++;
+    return h * 0.5;
+}
+
+double rollout(Board board, int depth_limit, lbit256* played, bool eval_cutoff) {
+    PROFILE_SCOPE(PROF_ROLLOUT);
+    Rng& rng = rollout_rng;
+    if (eval_cutoff && !board.track_patterns) board.enable_patterns();
     
     int depth = 0;
     while (!board.isTerminal() && depth < depth_limit) {
         // Use popbit() for fast random move selection
         lbit256 moves = board.nxt;
         int move_count = moves.popcount();
-        if (move_count == 0) return 0.5;  // Draw
+        if (move_count == 0) {
+            search_stats.rollouts++;
+            search_stats.rollout_length[std::min(depth / 10, STATS_ROLLOUT_BUCKETS - 1)]++;
+            search_stats.rollout_results[ROLLOUT_DRAW]++;
+            return 0.5;  // Draw
+        }
         
-        int target = xorshift64(rng_state) % move_count;
+        int target = rng.next() % move_count;
         
         // Pop 'target' bits to reach the target-th move
         int move = -1;
@@ -318,13 +487,19 @@ double rollout(Board board, int depth_limit) {
         
         if (move == -1) return 0.5;  // Safety fallback
         
+        if (played) played[board.side()].set(move);
         board.set(move);
         depth++;
     }
     
+    search_stats.rollouts++;
+    search_stats.rollout_length[std::min(depth / 10, STATS_ROLLOUT_BUCKETS - 1)]++;
     if (board.isTerminal()) {
+        search_stats.rollout_results[board.res]++;
         return board.res;  // 1 = black win, 0 = white win
     }
+    search_stats.rollout_results[ROLLOUT_CUTOFF]++;
+    if (eval_cutoff) return sample_half(evaluate(board), rng);
     return 0.5;  // Draw (max depth reached)
 }
 
@@ -334,6 +509,8 @@ double rollout(Board board, int depth_limit) {
 // ============================================================================
 int scan_all_threats(const Board& board, int player,
                      int* move_list, int& move_count, bool is_self) {
+    PROFILE_SCOPE(PROF_SCAN_ALL_THREATS);
+    search_stats.scan_all_calls++;
     move_count = 0;
     int best_level = THREAT_NONE;
     int opp = 1 - player;
@@ -541,6 +718,7 @@ int scan_all_threats(const Board& board, int player,
 // Check if opponent blocks any pattern positions in the 5-cell window around p
 // A threat pattern requires certain positions to be empty (not occupied by opponent)
 static bool opponent_blocks_pattern(int player_mask, int opp_mask, int p) {
+    PROFILE_SCOPE(PROF_OPPONENT_BLOCKS);
     // The 5-cell window around p: positions p-4 to p+4 
     // For a valid threat at p, opponent cannot occupy positions that 
     // the pattern considers "empty" (where player doesn't have a piece)
@@ -565,6 +743,7 @@ static bool opponent_blocks_pattern(int player_mask, int opp_mask, int p) {
 
 int scan_threats(const Board& board, int last_move, int player,
                  int* move_list, int& move_count, bool is_self) {
+    PROFILE_SCOPE(PROF_SCAN_THREATS);
     move_count = 0;
     if (last_move < 0) return THREAT_NONE;
     
@@ -759,18 +938,287 @@ int scan_threats(const Board& board, int last_move, int player,
     return best_level;
 }
 
+// ============================================================================
+// Symmetry pruning
+// In symmetric positions (mostly the first few moves) mirror-equivalent moves
+// lead to equivalent subtrees, so only the lowest index of each orbit is kept.
+// ============================================================================
+static lbit256 canonical_moves(lbit256 moves, int sym_mask) {
+    lbit256 result;
+    while (!moves.empty()) {
+        int m = moves.popbit();
+        bool canonical = true;
+        for (int k = 1; k < NUM_SYMMETRIES; k++) {
+            if (((sym_mask >> k) & 1) && sym_table[k][m] < m) {
+                canonical = false;
+                break;
+            }
+        }
+        if (canonical) result.set(m);
+    }
+    return result;
+}
+
+lbit256 canonical_moves(const Board& board, lbit256 moves) {
+    int sym_mask = board.symmetries();
+    if (sym_mask == 1) return moves;
+    return canonical_moves(moves, sym_mask);
+}
+
+// Symmetry mask worth pruning with at this node (1 = identity only)
+static inline int shallow_symmetries(const Board& board) {
+    if (board.cnt > SYMMETRY_MAX_MOVES) return 1;
+    return board.symmetries();
+}
+
+// ============================================================================
+// Move ordering for progressive widening
+// For each of the four lines through the move, stones of each side within
+// reach (4 cells) count quadratically, unless the other side sits between
+// them and the move. Threat-table hits add a large bonus. Moves next to the
+// last two moves get a small proximity bonus.
+// ============================================================================
+static inline int line_reach(int own, int opp, int p) {
+    // Stones of 'own' reachable from p in both directions before hitting 'opp'
+    int cnt = 0;
+    for (int i = p + 1; i <= p + 4 && i < 15 && !((opp >> i) & 1); i++) cnt += (own >> i) & 1;
+    for (int i = p - 1; i >= p - 4 && i >= 0 && !((opp >> i) & 1); i--) cnt += (own >> i) & 1;
+    return cnt;
+}
+
+static inline int chebyshev(int a, int b) {
+    return std::max(std::abs(row_id[a] - row_id[b]), std::abs(col_id[a] - col_id[b]));
+}
+
+int move_order_score(const Board& board, int move, int lst1, int lst2) {
+    int side = board.side();
+    int r = row_id[move];
+    int c = col_id[move];
+    int d1 = diag1_idx[move];
+    int d2 = diag2_idx[move];
+    
+    const int lines[2][4] = {
+        {board.row[0][r], board.col[0][c], board.diag1[0][d1], board.diag2[0][d2]},
+        {board.row[1][r], board.col[1][c], board.diag1[1][d1], board.diag2[1][d2]}
+    };
+    const int pos[4] = {c, r, diag1_idy[move], diag2_idy[move]};
+    
+    int score = 0;
+    for (int l = 0; l < 4; l++) {
+        for (int p = 0; p < 2; p++) {
+            int own = lines[p][l];
+            int opp = lines[1 - p][l];
+            int n = line_reach(own, opp, pos[l]);
+            int weight = (p == side) ? 3 : 2;  // Attack slightly above defence
+            score += weight * n * n;
+            int t = std::max(threat_table[own][pos[l]], winning_table[own][pos[l]]);
+            if (t > 0 && !opponent_blocks_pattern(own, opp, pos[l])) {
+                score += weight * 16 * t;
+            }
+        }
+    }
+    
+    if (lst1 >= 0 && chebyshev(move, lst1) <= 2) score += 3 - chebyshev(move, lst1);
+    if (lst2 >= 0 && chebyshev(move, lst2) <= 2) score += 3 - chebyshev(move, lst2);
+    return score;
+}
+
+// Highest-scoring move in 'moves' (lowest index on ties), -1 if empty
+static int best_ordered_move(const Board& board, lbit256 moves, int lst1, int lst2) {
+    int best_move = -1;
+    int best_score = -1;
+    while (!moves.empty()) {
+        int m = moves.popbit();
+        int sc = move_order_score(board, m, lst1, lst2);
+        if (sc > best_score) {
+            best_score = sc;
+            best_move = m;
+        }
+    }
+    return best_move;
+}
+
+// Candidate moves for widening at this node (symmetry-pruned when shallow)
+static lbit256 widening_candidates(const Board& board) {
+    lbit256 moves = board.nxt;
+    int sym_mask = shallow_symmetries(board);
+    if (sym_mask != 1) {
+        moves = canonical_moves(moves, sym_mask);
+    }
+    return moves;
+}
+
+// Build the node's ordered candidate list (once per node)
+static void build_move_order(Node& node, const Board& board, int lst1, int lst2) {
+    int scores[225];
+    int moves[225];
+    int n = 0;
+    
+    lbit256 cand = widening_candidates(board);
+    while (!cand.empty()) {
+        int m = cand.popbit();
+        moves[n] = m;
+        scores[m] = move_order_score(board, m, lst1, lst2);
+        n++;
+    }
+    
+    int keep = std::min(n, ORDER_LIST_MAX);
+    if (move_order_count + keep > move_order_capacity) {
+        node.order_ofs = -2;  // Pool exhausted: pick moves on the fly
+        return;
+    }
+    
+    // Stable on index order, so ties keep the lowest index first
+    std::partial_sort(moves, moves + keep, moves + n, [&](int a, int b) {
+        return scores[a] > scores[b] || (scores[a] == scores[b] && a < b);
+    });
+    
+    node.order_ofs = move_order_count;
+    node.order_len = (uint8_t)keep;
+    node.order_pos = 0;
+    for (int i = 0; i < keep; i++) {
+        move_order_pool[move_order_count++] = (uint8_t)moves[i];
+    }
+}
+
+// Next move to add as a child of the node, -1 if all candidates are expanded
+static int next_widening_move(Node& node, const Board& board, int lst1, int lst2) {
+    if (node.order_ofs == -1) {
+        build_move_order(node, board, lst1, lst2);
+    }
+    if (node.order_ofs >= 0) {
+        if (node.order_pos < node.order_len) {
+            return move_order_pool[node.order_ofs + node.order_pos];
+        }
+        if (node.order_len < ORDER_LIST_MAX) {
+            return -1;  // The list held every candidate and all are expanded
+        }
+    }
+    
+    // List truncated and used up, or no list: choose among the remaining moves
+    lbit256 expanded_moves;
+    for (int child = node.fst_child; child != -1; child = nodes[child].nxt_sib) {
+        expanded_moves.set(nodes[child].move);
+    }
+    return best_ordered_move(board, widening_candidates(board) & ~expanded_moves, lst1, lst2);
+}
+
 // ============================================================================
 // UCB1 calculation
 // ============================================================================
-static inline double ucb(int wins, int visits, int parent_visits, int side) {
+static inline double ucb(const Node& child, int parent_visits, int side) {
+    PROFILE_SCOPE(PROF_UCB);
+    int wins = child.wins;
+    int visits = child.visits;
     if (visits == 0) return 1e18;  // Unvisited node has infinite priority
     
     // wins is from black's perspective
     // If it's white's turn (side=1), we want to minimize black's wins
     double win_rate = (double)wins / (2.0 * visits);  // Divide by 2 because wins are scaled
+    
+    // RAVE: blend in the AMAF win rate with a weight that decays with visits
+    if (opt.rave && child.rave_visits > 0) {
+        double rave_rate = (double)child.rave_wins / (2.0 * child.rave_visits);
+        double k = opt.rave_k;
+        double beta = sqrt(k / (3.0 * visits + k));
+        win_rate = (1.0 - beta) * win_rate + beta * rave_rate;
+    }
+    
     if (side == 1) win_rate = 1.0 - win_rate;  // Flip for white
     
-    return win_rate + MCTS_C * sqrt(log((double)parent_visits) / visits);
+    return win_rate + opt.c * sqrt(log((double)parent_visits) / visits);
+}
+
+// ============================================================================
+// RAVE backup: after playing 'move' from 'node', credit every child of the
+// node whose move was also played later in this iteration by the same side.
+// After a batched rollout a move played only in some lanes gets those lanes'
+// results, one visit each.
+// ============================================================================
+static void update_rave(Node& node, int side, int move, double result) {
+    amaf_played[side].set(move);
+    int k = opt.rollouts;
+    int w = (int)lround(result * 2 * k);
+    for (int child = node.fst_child; child != -1; child = nodes[child].nxt_sib) {
+        int m = nodes[child].move;
+        if (amaf_played[side].get(m)) {
+            nodes[child].rave_wins += w;
+            nodes[child].rave_visits += k;
+        } else if (amaf_lanes > 0 && amaf_lane_union[side].get(m)) {
+            for (int l = 0; l < amaf_lanes; l++) {
+                if (amaf_lane_played[l][side].get(m)) {
+                    nodes[child].rave_wins += amaf_lane_wins[l];
+                    nodes[child].rave_visits++;
+                }
+            }
+        }
+    }
+}
+
+// ============================================================================
+// Backup: every iteration adds opt.rollouts visits to each node
+// on its path. result is the mean over that many rollouts, so the half-win
+// total result * 2 * rollouts is an exact integer.
+// ============================================================================
+static inline void add_result(Node& node, double result) {
+    int k = opt.rollouts;
+    node.wins += (int)lround(result * 2 * k);
+    node.visits += k;
+}
+
+// Leaf evaluation: one rollout, or a lock-step batch of them
+static double leaf_rollout(const Board& board) {
+    long long rollout_start = now_ns();
+    bool eval = opt.rollout_eval > 0;
+    int depth = eval ? std::min(opt.rollout_eval, opt.rollout_depth) : opt.rollout_depth;
+    double result;
+    if (opt.rollouts > 1) {
+        result = rollout_batch(board, opt.rollouts, depth, opt.rave ? amaf_lane_played : nullptr, eval,
+                               opt.rave ? amaf_lane_wins : nullptr);
+        if (opt.rave) {
+            amaf_lanes = opt.rollouts;
+            amaf_lane_union[0] = amaf_lane_union[1] = lbit256();
+            for (int l = 0; l < amaf_lanes; l++) {
+                amaf_lane_union[0] |= amaf_lane_played[l][0];
+                amaf_lane_union[1] |= amaf_lane_played[l][1];
+            }
+        }
+    } else {
+        result = rollout(board, depth, opt.rave ? amaf_played : nullptr, eval);
+    }
+    search_stats.rollout_ms += (now_ns() - rollout_start) * 1e-6;
+    return result;
+}
+
+// ============================================================================
+// Multi-PV: at the root, the top opt.multipv children by visits each keep at
+// least MULTIPV_MIN_SHARE / multipv of the root visits. Returns the least
+// visited of them while it is below that floor, MULTIPV_WIDEN while the
+// root can still widen to multipv children, or -1 to select by UCB.
+// ============================================================================
+constexpr int MULTIPV_WIDEN = -2;
+
+static int multipv_child(const Node& root) {
+    int k = opt.multipv;
+    int top[225];
+    int n = 0;
+    for (int child = root.fst_child; child != -1; child = nodes[child].nxt_sib) {
+        // Insertion into the top k by visits (ties keep child order)
+        int v = nodes[child].visits;
+        int i = n < k ? n++ : k;
+        if (i == k && nodes[top[k - 1]].visits >= v) continue;
+        if (i == k) i = k - 1;
+        while (i > 0 && nodes[top[i - 1]].visits < v) {
+            top[i] = top[i - 1];
+            i--;
+        }
+        top[i] = child;
+    }
+    if (n < k && !root.fully_expanded) return MULTIPV_WIDEN;
+    if (n == 0) return -1;
+    int last = top[n - 1];
+    double floor = MULTIPV_MIN_SHARE * root.visits / k;
+    return nodes[last].visits < floor ? last : -1;
 }
 
 // ============================================================================
@@ -782,20 +1230,21 @@ double dfs(int node_id, int lst1, int lst2, Board& board) {
     // Terminal check
     if (board.isTerminal()) {
         double result = board.res;  // 1.0 for black win, 0.0 for white win
-        node.wins += (int)(result * 2);  // Scale by 2 for half-wins
-        node.visits++;
+        add_result(node, result);
         return result;
     }
     
     int side = board.side();  // 0 = black to move, 1 = white to move
     
+    int forced = opt.multipv > 1 && node_id == tree_root ? multipv_child(node) : -1;
+    
     // If fully expanded, select best child
     if (node.fully_expanded) {
-        int best_child = -1;
+        int best_child = forced >= 0 ? forced : -1;
         double best_ucb = -1e18;
         
-        for (int child = node.fst_child; child != -1; child = nodes[child].nxt_sib) {
-            double u = ucb(nodes[child].wins, nodes[child].visits, node.visits, side);
+        for (int child = node.fst_child; child != -1 && forced < 0; child = nodes[child].nxt_sib) {
+            double u = ucb(nodes[child], node.visits, side);
             if (u > best_ucb) {
                 best_ucb = u;
                 best_child = child;
@@ -809,9 +1258,9 @@ double dfs(int node_id, int lst1, int lst2, Board& board) {
         
         board.set(nodes[best_child].move);
         double result = dfs(best_child, lst2, nodes[best_child].move, board);
+        if (opt.rave) update_rave(node, side, nodes[best_child].move, result);
         
-        node.wins += (int)(result * 2);
-        node.visits++;
+        add_result(node, result);
         return result;
     }
     
@@ -820,6 +1269,7 @@ double dfs(int node_id, int lst1, int lst2, Board& board) {
         int move_list[64];
         int move_count = 0;
         int best_threat = THREAT_NONE;
+        long long scan_start = now_ns();
         
         // Scan for our winning moves
         // If lst2 == -1 (at root), scan entire board
@@ -840,6 +1290,7 @@ double dfs(int node_id, int lst1, int lst2, Board& board) {
         } else {
             opp_threat = scan_threats(board, lst1, 1 - side, opp_moves, opp_count, false);
         }
+        search_stats.threat_ms += (now_ns() - scan_start) * 1e-6;
         
         // Combine: prioritize by level
         if (self_threat >= opp_threat && self_threat > THREAT_NONE) {
@@ -854,7 +1305,26 @@ double dfs(int node_id, int lst1, int lst2, Board& board) {
             }
         }
         
+        // Drop threat moves that mirror another one in a symmetric position
+        int sym_mask = (move_count > 1) ? shallow_symmetries(board) : 1;
+        if (sym_mask != 1) {
+            lbit256 threat_set;
+            for (int i = 0; i < move_count; i++) threat_set.set(move_list[i]);
+            lbit256 keep = canonical_moves(threat_set, sym_mask);
+            int kept = 0;
+            for (int i = 0; i < move_count; i++) {
+                if (keep.get(move_list[i])) move_list[kept++] = move_list[i];
+            }
+            move_count = kept;
+        }
+        
         if (best_threat > THREAT_NONE && move_count > 0) {
+            if (best_threat == THREAT_OPEN4_WIN || best_threat == THREAT_LIVE3_WIN) {
+                search_stats.threat_hits_self++;
+            } else {
+                search_stats.threat_hits_opp++;
+            }
+            
             // Expand only threat moves, mark fully expanded
             for (int i = 0; i < move_count; i++) {
                 int child_id = alloc_node();
@@ -871,28 +1341,27 @@ double dfs(int node_id, int lst1, int lst2, Board& board) {
             int child = node.fst_child;
             board.set(nodes[child].move);
             double result = dfs(child, lst2, nodes[child].move, board);
+            if (opt.rave) update_rave(node, side, nodes[child].move, result);
             
-            node.wins += (int)(result * 2);
-            node.visits++;
+            add_result(node, result);
             return result;
         }
         
         // No threats - do rollout
-        double result = rollout(board);
-        node.wins += (int)(result * 2);
-        node.visits++;
+        double result = leaf_rollout(board);
+        add_result(node, result);
         return result;
     }
     
     // Node has been visited but not fully expanded
     // Check iterative expansion: if C * sqrt(ln(visits)) > max UCB of children, expand
-    double expand_threshold = MCTS_C * sqrt(log((double)node.visits));
+    double expand_threshold = opt.c * sqrt(log((double)node.visits));
     
     int best_child = -1;
     double best_ucb = -1e18;
     
     for (int child = node.fst_child; child != -1; child = nodes[child].nxt_sib) {
-        double u = ucb(nodes[child].wins, nodes[child].visits, node.visits, side);
+        double u = ucb(nodes[child], node.visits, side);
         if (u > best_ucb) {
             best_ucb = u;
             best_child = child;
@@ -900,32 +1369,26 @@ double dfs(int node_id, int lst1, int lst2, Board& board) {
     }
     
     // If we should expand a new node
-    if (best_child == -1 || expand_threshold > best_ucb) {
-        // Find an unexpanded move
-        lbit256 expanded_moves;
-        for (int child = node.fst_child; child != -1; child = nodes[child].nxt_sib) {
-            expanded_moves.set(nodes[child].move);
-        }
-        
-        lbit256 unexpanded = board.nxt & ~expanded_moves;
+    if (best_child == -1 || expand_threshold > best_ucb || forced == MULTIPV_WIDEN) {
+        // Next unexpanded move in heuristic order
+        int new_move = next_widening_move(node, board, lst1, lst2);
         
-        if (!unexpanded.empty()) {
-            int new_move = unexpanded.popbit();
-            
+        if (new_move != -1) {
             int child_id = alloc_node();
             if (child_id != -1) {
+                if (node.order_pos < node.order_len) node.order_pos++;
                 nodes[child_id].fa = node_id;
                 nodes[child_id].move = new_move;
                 nodes[child_id].nxt_sib = node.fst_child;
                 node.fst_child = child_id;
                 
+                search_stats.widenings++;
                 board.set(new_move);
-                double result = rollout(board);
+                double result = leaf_rollout(board);
+                if (opt.rave) update_rave(node, side, new_move, result);
                 
-                nodes[child_id].wins += (int)(result * 2);
-                nodes[child_id].visits++;
-                node.wins += (int)(result * 2);
-                node.visits++;
+                add_result(nodes[child_id], result);
+                add_result(node, result);
                 return result;
             }
         } else {
@@ -935,12 +1398,13 @@ double dfs(int node_id, int lst1, int lst2, Board& board) {
     }
     
     // Select best child and recurse
+    if (forced >= 0) best_child = forced;
     if (best_child != -1) {
         board.set(nodes[best_child].move);
         double result = dfs(best_child, lst2, nodes[best_child].move, board);
+        if (opt.rave) update_rave(node, side, nodes[best_child].move, result);
         
-        node.wins += (int)(result * 2);
-        node.visits++;
+        add_result(node, result);
         return result;
     }
     
@@ -948,13 +1412,255 @@ double dfs(int node_id, int lst1, int lst2, Board& board) {
     return 0.5;
 }
 
+// ============================================================================
+// Search statistics
+// ============================================================================
+static void json_array(std::ostringstream& oss, const long long* v, int n) {
+    oss << "[";
+    for (int i = 0; i < n; i++) oss << (i ? "," : "") << v[i];
+    oss << "]";
+}
+
+std::string search_stats_json(const SearchStats& st) {
+    std::ostringstream oss;
+    oss << "{\"iterations\":" << st.iterations
+        << ",\"nodes_allocated\":" << st.nodes_allocated
+        << ",\"peak_nodes\":" << st.peak_nodes
+        << ",\"max_nodes\":" << st.max_nodes
+        << ",\"threat_hits_self\":" << st.threat_hits_self
+        << ",\"threat_hits_opp\":" << st.threat_hits_opp
+        << ",\"scan_all_calls\":" << st.scan_all_calls
+        << ",\"rollouts\":" << st.rollouts
+        << ",\"rollout_length\":";
+    json_array(oss, st.rollout_length, STATS_ROLLOUT_BUCKETS);
+    oss << ",\"rollout_results\":{\"white\":" << st.rollout_results[ROLLOUT_WHITE_WIN]
+        << ",\"black\":" << st.rollout_results[ROLLOUT_BLACK_WIN]
+        << ",\"draw\":" << st.rollout_results[ROLLOUT_DRAW]
+        << ",\"cutoff\":" << st.rollout_results[ROLLOUT_CUTOFF] << "}"
+        << ",\"depth\":";
+    json_array(oss, st.depth, STATS_MAX_DEPTH);
+    oss << ",\"widenings\":" << st.widenings;
+    oss.setf(std::ios::fixed);
+    oss.precision(3);
+    oss << ",\"time_ms\":{\"total\":" << st.total_ms
+        << ",\"threat\":" << st.threat_ms
+        << ",\"rollout\":" << st.rollout_ms
+        << ",\"tree\":" << std::max(0.0, st.total_ms - st.threat_ms - st.rollout_ms) << "}}";
+    return oss.str();
+}
+
+// ============================================================================
+// Persistent tree management
+// ============================================================================
+// Root statistics summed over all trees by the last parallel search on this
+// thread; valid until the tree or its root changes
+static thread_local RootStats merged_root;
+static thread_local bool merged_root_valid = false;
+
+static void tree_clear(const Board& board) {
+    merged_root_valid = false;
+    reset_nodes();
+    tree_root = alloc_node();
+    tree_board = board;
+}
+
+// Child of 'node' reached by 'move', -1 if not expanded
+static int find_child(int node, int move) {
+    for (int child = nodes[node].fst_child; child != -1; child = nodes[child].nxt_sib) {
+        if (nodes[child].move == move) return child;
+    }
+    return -1;
+}
+
+bool tree_set_position(const Board& board) {
+    merged_root_valid = false;
+    // Keep the tree only while plenty of the pool is left for the next search
+    // and the pool has the size that search asks for
+    bool usable = tree_root >= 0 && node_capacity == opt.nodes && node_count < node_capacity / 2;
+    int node = tree_root;
+    lbit256 stones[2] = {tree_board.b[0], tree_board.b[1]};
+    int cnt = tree_board.cnt;
+    
+    // Step up the parent chain while the node has stones the board lacks
+    // (takeback); the pool keeps ancestors of the root until the next reset
+    while (usable) {
+        lbit256 extra = (stones[0] & ~board.b[0]) | (stones[1] & ~board.b[1]);
+        if (extra.empty()) break;
+        int s = (cnt - 1) & 1;  // Side that played the node's move
+        int move = nodes[node].move;
+        if (nodes[node].fa == -1 || move < 0 || !stones[s].get(move)) {
+            usable = false;
+            break;
+        }
+        stones[s].clear(move);
+        node = nodes[node].fa;
+        cnt--;
+    }
+    usable = usable && board.cnt >= cnt && board.cnt <= cnt + 2;
+    
+    if (usable) {
+        // With at most one new stone per side the move order is fixed:
+        // the node's side to move played first
+        int first = cnt & 1;
+        lbit256 added[2] = {board.b[0] & ~stones[0], board.b[1] & ~stones[1]};
+        int plies = board.cnt - cnt;
+        
+        for (int i = 0; i < plies && node != -1; i++) {
+            int s = (first + i) & 1;
+            if (added[s].popcount() != 1) { node = -1; break; }
+            int move = added[s].popbit();
+            node = find_child(node, move);
+        }
+        
+        if (node != -1) {
+            tree_root = node;
+            tree_board = board;
+            return true;
+        }
+    }
+    
+    tree_clear(board);
+    return false;
+}
+
 // ============================================================================
 // getBest - main MCTS entry point
 // ============================================================================
 int getBest(Board& board, int iters) {
-    reset_nodes();
+    SearchLimits limits;
+    limits.iters = iters;
+    return getBest(board, limits);
+}
+
+// ============================================================================
+// Root analysis
+// ============================================================================
+// Most-visited line below 'node' (children with visits only)
+static void append_pv(int node, std::vector<int>& pv) {
+    while (node != -1) {
+        int best = -1;
+        for (int child = nodes[node].fst_child; child != -1; child = nodes[child].nxt_sib) {
+            if (nodes[child].visits > 0 && (best == -1 || nodes[child].visits > nodes[best].visits)) {
+                best = child;
+            }
+        }
+        if (best != -1) pv.push_back(nodes[best].move);
+        node = best;
+    }
+}
+
+static void own_root_stats(RootStats& out) {
+    out.visits = out.wins = out.count = 0;
+    std::fill(out.child_visits, out.child_visits + 225, 0);
+    std::fill(out.child_wins, out.child_wins + 225, 0);
+    if (tree_root < 0) return;
+    out.visits = nodes[tree_root].visits;
+    out.wins = nodes[tree_root].wins;
+    for (int c = nodes[tree_root].fst_child; c != -1 && out.count < 225; c = nodes[c].nxt_sib) {
+        int move = nodes[c].move;
+        out.moves[out.count++] = move;
+        out.child_visits[move] = nodes[c].visits;
+        out.child_wins[move] = nodes[c].wins;
+    }
+}
+
+void root_stats(RootStats& out) {
+    if (merged_root_valid) {
+        out = merged_root;
+    } else {
+        own_root_stats(out);
+    }
+}
+
+void root_analysis(std::vector<RootMove>& out, int max_moves) {
+    out.clear();
+    if (tree_root < 0) return;
+    RootStats own;
+    if (!merged_root_valid) own_root_stats(own);
+    const RootStats& stats = merged_root_valid ? merged_root : own;
+    int side = tree_board.side();
+    int moves[225];
+    int n = 0;
+    for (int i = 0; i < stats.count; i++) {
+        if (stats.child_visits[stats.moves[i]] > 0) moves[n++] = stats.moves[i];
+    }
+    std::stable_sort(moves, moves + n, [&](int a, int b) { return stats.child_visits[a] > stats.child_visits[b]; });
+    if (max_moves > 0) n = std::min(n, max_moves);
+    
+    out.resize(n);
+    for (int i = 0; i < n; i++) {
+        int move = moves[i];
+        RootMove& rm = out[i];
+        rm.move = move;
+        rm.visits = stats.child_visits[move];
+        double black = (double)stats.child_wins[move] / (2.0 * rm.visits);
+        rm.winrate = side == 0 ? black : 1.0 - black;
+        rm.pv.assign(1, move);
+        append_pv(find_child(tree_root, move), rm.pv);
+    }
+}
+
+std::string root_move_line(const RootMove& rm) {
+    char wr[16];
+    snprintf(wr, sizeof(wr), "%.4f", rm.winrate);
+    std::ostringstream oss;
+    oss << "move " << rm.move << " visits " << rm.visits << " winrate " << wr << " pv";
+    for (int m : rm.pv) oss << " " << m;
+    return oss.str();
+}
+
+// Root statistics for progress reports
+static void fill_search_info(SearchInfo& info, int root, int side, int analysis) {
+    info.nodes = node_count;
+    const Node& r = nodes[root];
+    info.winrate = r.visits > 0 ? (double)r.wins / (2.0 * r.visits) : 0.5;
+    if (side == 1) info.winrate = 1.0 - info.winrate;
     
-    int root = alloc_node();
+    info.pv.clear();
+    info.moves.clear();
+    if (analysis != 0) {
+        root_analysis(info.moves, analysis < 0 ? 0 : analysis);
+        if (!info.moves.empty()) info.pv = info.moves[0].pv;
+    } else {
+        append_pv(root, info.pv);
+    }
+}
+
+// Move for a root without children (e.g. the node pool ran out): the
+// strongest threat move, as the root expansion would pick, else any legal move
+static int fallback_move(const Board& board) {
+    int self_moves[64], self_count = 0;
+    int opp_moves[64], opp_count = 0;
+    int self_threat = scan_all_threats(board, board.side(), self_moves, self_count, true);
+    int opp_threat = scan_all_threats(board, 1 - board.side(), opp_moves, opp_count, false);
+    if (self_threat >= opp_threat && self_threat > THREAT_NONE && self_count > 0) return self_moves[0];
+    if (opp_threat > THREAT_NONE && opp_count > 0) return opp_moves[0];
+    lbit256 moves = board.nxt;
+    return moves.empty() ? -1 : moves.popbit();
+}
+
+// Search the position on the calling thread's tree
+static thread_local long long slice_iterations = 0;  // Iterations of the last search_tree call
+
+static int search_tree(Board& board, const SearchLimits& limits) {
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+    opt = limits.options ? *limits.options : search_options;
+    bool resume = limits.resume && tree_root >= 0 && node_capacity == opt.nodes &&
+                  tree_board.cnt == board.cnt && (tree_board.b[0] & ~board.b[0]).empty() &&
+                  (tree_board.b[1] & ~board.b[1]).empty();
+    slice_iterations = 0;
+    merged_root_valid = false;
+    if (!resume) {
+        search_stats.reset();
+        rollout_rng.seed(opt.seed, limits.rng_stream);
+        if (limits.reuse_tree) {
+            tree_set_position(board);
+        } else {
+            tree_clear(board);
+        }
+    }
+    int root = tree_root;
     
     // Handle first move - play center
     if (board.cnt == 0) {
@@ -971,9 +1677,56 @@ int getBest(Board& board, int iters) {
     // At root, opponent just played, so board.last_move is opponent's move
     int opponent_last = board.last_move;
     
-    for (int i = 0; i < iters; i++) {
-        Board copy = board;
+    // Evaluation cutoffs read the pattern counts: track them from the root
+    Board root_board = board;
+    if (opt.rollout_eval > 0 && !root_board.track_patterns) root_board.enable_patterns();
+    
+    SearchInfo info;
+    info.max_depth = 0;
+    int next_info_ms = limits.info_interval_ms;
+    bool timed = limits.movetime_ms > 0 || limits.info_interval_ms > 0;
+    
+    // The first iteration always runs, so a search stopped at once still
+    // expands the root and has a move to return
+    int i = 0;
+    for (; limits.iters <= 0 || i < limits.iters; i++) {
+        if (i > 0 && limits.stop && limits.stop->load(std::memory_order_relaxed)) break;
+        
+        // Clock checks every 16 iterations (~0.3 ms)
+        if (timed && i > 0 && (i & 15) == 0) {
+            int elapsed = (int)std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start).count();
+            if (limits.movetime_ms > 0 && elapsed >= limits.movetime_ms) break;
+            if (limits.info_interval_ms > 0 && elapsed >= next_info_ms && limits.on_info) {
+                info.iters = i;
+                info.elapsed_ms = elapsed;
+                fill_search_info(info, root, board.side(), limits.analysis);
+                limits.on_info(info);
+                next_info_ms = elapsed + limits.info_interval_ms;
+            }
+        }
+        
+        Board copy = root_board;
+        if (opt.rave) {
+            amaf_played[0] = amaf_played[1] = lbit256();
+            amaf_lanes = 0;
+        }
         dfs(root, opponent_last, -1, copy);
+        int depth = copy.cnt - board.cnt;
+        info.max_depth = std::max(info.max_depth, depth);
+        search_stats.depth[std::min(depth, STATS_MAX_DEPTH - 1)]++;
+    }
+    
+    slice_iterations = i;
+    search_stats.iterations += i;
+    search_stats.peak_nodes = std::max(search_stats.peak_nodes, node_count);
+    search_stats.max_nodes = node_capacity;
+    search_stats.total_ms += std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    
+    if (limits.on_info) {
+        info.iters = i;
+        info.elapsed_ms = (int)std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start).count();
+        fill_search_info(info, root, board.side(), limits.analysis);
+        limits.on_info(info);
     }
     
     // Select move with most visits
@@ -987,5 +1740,169 @@ int getBest(Board& board, int iters) {
         }
     }
     
+    return best_move >= 0 ? best_move : fallback_move(board);
+}
+
+// ============================================================================
+// Root-parallel search. Helper threads are started on first use and kept,
+// so each keeps its node pool and tree between searches like the caller.
+// Helper i (1-based) takes part while i < threads and writes its root
+// statistics to stats[i].
+// ============================================================================
+struct HelperPool {
+    std::mutex search_mutex;        // One parallel search at a time
+    std::mutex m;
+    std::condition_variable start_cv;
+    std::condition_variable done_cv;
+    int started = 0;                // Helper threads running
+    uint64_t generation = 0;        // Bumped for every search
+    int threads = 1;                // Threads in the current search (caller included)
+    int pending = 0;                // Helpers still searching
+    Board board;
+    SearchLimits limits;
+    SearchOptions options;
+    RootStats stats[MAX_SEARCH_THREADS];
+    long long iterations[MAX_SEARCH_THREADS];   // Of the current search
+};
+
+// Never destroyed: detached helpers may still be waiting at exit
+static HelperPool& helper_pool() {
+    static HelperPool* pool = new HelperPool;
+    return *pool;
+}
+
+// Thread 'index' of 'threads' runs this share of an iteration limit
+static int iteration_share(int iters, int index, int threads) {
+    if (iters <= 0) return 0;
+    return iters / threads + (index < iters % threads ? 1 : 0);
+}
+
+static void helper_main(int index) {
+    HelperPool& pool = helper_pool();
+    uint64_t seen = 0;
+    while (true) {
+        Board board;
+        SearchLimits limits;
+        {
+            std::unique_lock<std::mutex> lock(pool.m);
+            pool.start_cv.wait(lock, [&]() { return pool.generation != seen; });
+            seen = pool.generation;
+            if (index >= pool.threads) continue;
+            board = pool.board;
+            limits = pool.limits;
+            limits.iters = iteration_share(limits.iters, index, pool.threads);
+            limits.rng_stream ^= (uint64_t)index << 56;
+        }
+        search_tree(board, limits);
+        std::lock_guard<std::mutex> lock(pool.m);
+        own_root_stats(pool.stats[index]);
+        pool.iterations[index] = slice_iterations;
+        if (--pool.pending == 0) pool.done_cv.notify_all();
+    }
+}
+
+static int search_parallel(Board& board, const SearchLimits& limits, const SearchOptions& options) {
+    HelperPool& pool = helper_pool();
+    std::lock_guard<std::mutex> search_lock(pool.search_mutex);
+    int threads = options.threads;
+    if (limits.iters > 0) threads = std::min(threads, limits.iters);
+
+    SearchOptions single = options;
+    single.threads = 1;
+    {
+        std::lock_guard<std::mutex> lock(pool.m);
+        while (pool.started < threads - 1) {
+            std::thread(helper_main, ++pool.started).detach();
+        }
+        pool.board = board;
+        pool.options = single;
+        pool.limits = limits;
+        pool.limits.options = &pool.options;
+        pool.limits.info_interval_ms = 0;
+        pool.limits.on_info = nullptr;
+        pool.threads = threads;
+        pool.pending = threads - 1;
+        pool.generation++;
+    }
+    pool.start_cv.notify_all();
+
+    SearchLimits own = limits;
+    own.options = &single;
+    own.iters = iteration_share(limits.iters, 0, threads);
+    int best_move = search_tree(board, own);
+
+    RootStats& merged = merged_root;
+    own_root_stats(merged);
+    bool listed[225] = {};
+    for (int i = 0; i < merged.count; i++) listed[merged.moves[i]] = true;
+    std::unique_lock<std::mutex> lock(pool.m);
+    pool.done_cv.wait(lock, [&]() { return pool.pending == 0; });
+    for (int t = 1; t < threads; t++) {
+        const RootStats& s = pool.stats[t];
+        merged.visits += s.visits;
+        merged.wins += s.wins;
+        for (int i = 0; i < s.count; i++) {
+            int m = s.moves[i];
+            if (!listed[m]) {
+                listed[m] = true;
+                merged.moves[merged.count++] = m;
+            }
+            merged.child_visits[m] += s.child_visits[m];
+            merged.child_wins[m] += s.child_wins[m];
+        }
+        search_stats.iterations += pool.iterations[t];
+    }
+    merged_root_valid = true;
+
+    // Ties go to the first move in child order, as in root_analysis, so the
+    // top MultiPV line is the move played
+    int best_visits = 0;  // Keep the caller's move if no tree was searched
+    for (int i = 0; i < merged.count; i++) {
+        int m = merged.moves[i];
+        if (merged.child_visits[m] > best_visits) {
+            best_visits = merged.child_visits[m];
+            best_move = m;
+        }
+    }
     return best_move;
 }
+
+int getBest(Board& board, const SearchLimits& limits) {
+    const SearchOptions& options = limits.options ? *limits.options : search_options;
+    if (options.threads <= 1 || board.cnt == 0 || board.nxt.popcount() == 1) {
+        return search_tree(board, limits);
+    }
+    return search_parallel(board, limits, options);
+}
+
+int getBest(Board& board, const SearchLimits& limits, std::vector<RootMove>& lines) {
+    int best = getBest(board, limits);
+    const SearchOptions& options = limits.options ? *limits.options : search_options;
+    root_analysis(lines, options.multipv);
+    return best;
+}
+
+// ============================================================================
+// Random openings
+// ============================================================================
+static int random_bit(Rng& rng, lbit256 moves) {
+    int target = (int)(rng.next() % moves.popcount());
+    int move = -1;
+    for (int i = 0; i <= target; i++) move = moves.popbit();
+    return move;
+}
+
+void random_opening(Board& board, Rng& rng, int plies, std::vector<int>& moves) {
+    lbit256 center;
+    for (int r = 5; r <= 9; r++) {
+        for (int c = 5; c <= 9; c++) center.set(r * 15 + c);
+    }
+    for (int i = 0; i < plies; i++) {
+        int move = random_bit(rng, board.cnt == 0 ? center : board.nxt);
+        Board next = board;
+        next.set(move);
+        if (next.isTerminal()) break;
+        board = next;
+        moves.push_back(move);
+    }
+}
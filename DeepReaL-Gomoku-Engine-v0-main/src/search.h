@@ -2,7 +2,11 @@
 #define SEARCH_H
 
 #include "board.h"
+#include <atomic>
 #include <cmath>
+#include <functional>
+#include <string>
+#include <vector>
 
 // ============================================================================
 // Threat levels
@@ -27,7 +31,9 @@ void init_threat_tables();
 // ============================================================================
 // Node structure for MCTS tree
 // ============================================================================
-constexpr int MAX_NODES = 10000000;  // 10M nodes
+constexpr int MAX_NODES = 10000000;        // Default node budget (10M nodes)
+constexpr int MIN_NODE_BUDGET = 10000;     // Range of the NODES option
+constexpr int MAX_NODE_BUDGET = 100000000;
 
 struct Node {
     int fa;           // Parent index (-1 for root)
@@ -35,12 +41,20 @@ struct Node {
     int nxt_sib;      // Next sibling index (-1 if none)
     int move;         // Move that led to this node (-1 for root)
     int wins;         // Win count (from black's perspective, scaled by 2 for half-wins)
-    int visits;       // Visit count
+    int visits;       // Visit count (ROLLOUTS per iteration through the node)
+    int rave_wins;    // AMAF win count (same scaling as wins)
+    int rave_visits;  // AMAF visit count
+    int order_ofs;    // Widening order in move_order_pool (-1 = not built, -2 = pool full)
+    uint8_t order_len;  // Number of ordered candidates stored
+    uint8_t order_pos;  // Next candidate to expand
     bool fully_expanded;
     
     void init() {
         fa = fst_child = nxt_sib = move = -1;
         wins = visits = 0;
+        rave_wins = rave_visits = 0;
+        order_ofs = -1;
+        order_len = order_pos = 0;
         fully_expanded = false;
     }
 };
@@ -48,32 +62,273 @@ struct Node {
 // ============================================================================
 // MCTS Search
 // ============================================================================
-constexpr double MCTS_C = 2.0;           // Exploration constant
-constexpr int ROLLOUT_MAX_DEPTH = 100;   // Max rollout depth
+constexpr double MCTS_C = 2.0;           // Default exploration constant
+constexpr int ROLLOUT_MAX_DEPTH = 100;   // Default max rollout depth
+constexpr int SYMMETRY_MAX_MOVES = 12;   // Prune symmetric moves only while cnt <= this
+constexpr int ORDER_LIST_MAX = 32;       // Widening candidates ordered per node
+constexpr int MAX_ORDER_BYTES = 32 << 20; // Widening order storage at MAX_NODES (scales with the budget)
+constexpr double RAVE_K = 1000.0;        // RAVE equivalence parameter (visits at which beta = 0.5)
+constexpr uint64_t ROLLOUT_SEED = 12345678901234567ULL;  // Default rollout RNG seed
+constexpr int ROLLOUT_LANES = 8;         // Max rollouts played together per leaf
+// Root-parallel search threads. A WebAssembly module cannot start threads
+// while the engine worker blocks in a search, so there the helpers are
+// limited to the pre-started pool (GOMOKU_THREAD_POOL, the module's
+// PTHREAD_POOL_SIZE; none without pthreads).
+#if defined(__EMSCRIPTEN__)
+#ifndef GOMOKU_THREAD_POOL
+#define GOMOKU_THREAD_POOL 0
+#endif
+constexpr int MAX_SEARCH_THREADS = GOMOKU_THREAD_POOL + 1;
+#else
+constexpr int MAX_SEARCH_THREADS = 64;
+#endif
+constexpr double MULTIPV_MIN_SHARE = 0.5; // Root visits kept on the top MultiPV moves (each gets share / K)
 
-// Global node pool
-extern Node nodes[MAX_NODES];
-extern int node_count;
+// Static evaluation (evaluate): weights of the pattern windows in
+// Board::pat, side to move's counted EVAL_TEMPO times, and the scale of the
+// logistic that turns the score into a win probability
+constexpr int EVAL_WEIGHTS[PATTERN_TYPES] = {0, 1, 3, 4, 12, 16, 40};
+constexpr double EVAL_TEMPO = 1.5;
+constexpr double EVAL_SCALE = 24.0;
 
-// Reset the node pool
+// Runtime search options
+struct SearchOptions {
+    bool rave = false;        // Blend all-moves-as-first statistics into UCB
+    double rave_k = RAVE_K;   // RAVE weight decays as sqrt(k / (3 * visits + k))
+    uint64_t seed = ROLLOUT_SEED;  // Rollout RNG seed applied at the start of every search
+    int rollouts = 1;         // Rollouts per leaf (1..ROLLOUT_LANES); each counts as a visit
+    double c = MCTS_C;        // Exploration constant
+    int rollout_depth = ROLLOUT_MAX_DEPTH;  // Rollout length limit (plies)
+    int threads = 1;          // Root-parallel search threads (1..MAX_SEARCH_THREADS)
+    int nodes = MAX_NODES;    // Node pool size of each searching thread
+    int rollout_eval = 0;     // Plies after which rollouts stop and score evaluate() (0 = play out)
+    int multipv = 1;          // Root moves (by visits) kept at MULTIPV_MIN_SHARE / multipv of root visits each
+};
+extern SearchOptions search_options;  // Used by searches without SearchLimits::options
+
+// ============================================================================
+// Random numbers: xorshift64* streams. The start state is derived from
+// (seed, stream) with splitmix64, so workers sharing a seed but using
+// distinct stream ids draw independent sequences.
+// ============================================================================
+struct Rng {
+    uint64_t state;
+    
+    void seed(uint64_t seed, uint64_t stream = 0);
+    
+    inline uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1DULL;
+    }
+};
+
+// Rollout RNG of the calling thread; getBest re-seeds it from the SEED
+// option and SearchLimits::rng_stream
+extern thread_local Rng rollout_rng;
+
+// Set an option by name (as in "setoption name <name> value <value>")
+// Returns false if the name or value is not recognised
+bool set_search_option(SearchOptions& opts, const std::string& name, const std::string& value);
+bool set_search_option(const std::string& name, const std::string& value);  // search_options
+
+// Node pool. Each thread that searches has its own pool, tree and
+// statistics, so independent searches can run on different threads. The
+// pool (the NODES option, MAX_NODES by default) is allocated on the
+// thread's first reset_nodes, and again when a search asks for another
+// size; its pages are only touched as nodes are used.
+extern thread_local Node* nodes;
+extern thread_local int node_count;
+extern thread_local int node_capacity;  // Size of this thread's pool (0 = not allocated)
+
+// Reset the node pool, (re)allocating it at the current search's budget
 void reset_nodes();
 
 // Allocate a new node, returns node index
 int alloc_node();
 
+// Statistics of one root move (root analysis)
+struct RootMove {
+    int move;
+    int visits;
+    double winrate;         // For the side to move at the root
+    std::vector<int> pv;    // The move, then the most-visited children below it
+};
+
+// Progress report passed to SearchLimits::on_info
+struct SearchInfo {
+    int iters;              // Iterations run so far
+    int elapsed_ms;         // Time since the search started
+    int nodes;              // Nodes allocated in the pool
+    int max_depth;          // Deepest tree ply reached
+    double winrate;         // Root win rate for the side to move
+    std::vector<int> pv;    // Principal variation (most-visited children)
+    std::vector<RootMove> moves;  // Top SearchLimits::analysis root moves by visits
+};
+
+// Root statistics of the position tree_board. After a root-parallel search
+// they are summed over the trees of all threads, otherwise (and once the
+// tree changes) they come from the calling thread's tree.
+struct RootStats {
+    int visits;             // Root visits
+    int wins;               // Root wins (black's, x2)
+    int count;              // Root moves in 'moves'
+    int moves[225];         // Caller's child order, then moves only helpers expanded
+    int child_visits[225];  // By move (0 = not a root move)
+    int child_wins[225];    // By move (black's, x2)
+};
+void root_stats(RootStats& out);
+
+// Root moves of root_stats, most visited first (ties in child order), at
+// most max_moves of them (0 = all) with their PVs. The PV below the first
+// move comes from the calling thread's tree. Reads only the root's
+// children and the PV paths, so it is cheap enough for every progress report.
+void root_analysis(std::vector<RootMove>& out, int max_moves = 0);
+
+// "move <m> visits <n> winrate <p> pv <m> ..." for info lines
+std::string root_move_line(const RootMove& rm);
+
+// ============================================================================
+// Search statistics (filled by every getBest call, reset at its start
+// unless it resumes the previous search; per thread)
+// ============================================================================
+constexpr int STATS_ROLLOUT_BUCKETS = ROLLOUT_MAX_DEPTH / 10 + 1;  // Rollout length / 10
+constexpr int STATS_MAX_DEPTH = 32;                               // Tree depth histogram size
+
+// Rollout outcomes for SearchStats::rollout_results
+constexpr int ROLLOUT_WHITE_WIN = 0;
+constexpr int ROLLOUT_BLACK_WIN = 1;
+constexpr int ROLLOUT_DRAW = 2;         // No legal move left
+constexpr int ROLLOUT_CUTOFF = 3;       // depth_limit reached
+
+struct SearchStats {
+    long long iterations;
+    long long nodes_allocated;
+    int peak_nodes;                     // Highest pool usage (out of max_nodes)
+    int max_nodes;                      // Pool size of the searching thread (node_capacity)
+    long long threat_hits_self;         // Nodes expanded to our own threat moves only
+    long long threat_hits_opp;          // Nodes expanded to blocks of opponent threats only
+    long long scan_all_calls;           // Full-board threat scans
+    long long rollouts;
+    long long rollout_length[STATS_ROLLOUT_BUCKETS];
+    long long rollout_results[4];
+    long long depth[STATS_MAX_DEPTH];   // Tree plies per iteration (last bucket = deeper)
+    long long widenings;                // Children added by progressive widening
+    double total_ms;
+    double threat_ms;                   // In scan_threats/scan_all_threats at first visits
+    double rollout_ms;                  // In rollout()
+    
+    void reset() { *this = SearchStats(); }
+};
+extern thread_local SearchStats search_stats;
+
+// Statistics as a single-line JSON object
+std::string search_stats_json(const SearchStats& stats);
+
+// Search limits
+// The search stops at whichever of iters / movetime_ms is reached first;
+// with both 0 it runs until *stop is set.
+struct SearchLimits {
+    int iters = 10000;                          // Iterations to run (0 = no limit)
+    int movetime_ms = 0;                        // Time limit in ms (0 = no limit)
+    const std::atomic<bool>* stop = nullptr;    // Polled between iterations
+    bool reuse_tree = false;                    // Continue from the persistent tree if possible
+    int info_interval_ms = 0;                   // Call on_info this often (0 = only at the end)
+    std::function<void(const SearchInfo&)> on_info;
+    uint64_t rng_stream = 0;                    // Rollout RNG stream (distinct per parallel worker)
+    const SearchOptions* options = nullptr;     // Options for this search (nullptr = search_options)
+    bool resume = false;                        // Continue the previous search (see below)
+    int analysis = 0;                           // Root moves in SearchInfo::moves (0 = none, -1 = all)
+};
+
+// Persistent search tree of the calling thread, kept between searches so a
+// later search on a position reached from tree_board can continue from the
+// matching subtree
+extern thread_local int tree_root;      // Root node (-1 = empty tree)
+extern thread_local Board tree_board;   // Position at tree_root
+
+// Point the persistent tree at 'board'. If board is reached from
+// tree_board, or from a position before it (after a takeback), by at most
+// one move per side and that path exists in the tree, the matching node
+// becomes the new root; otherwise the tree is rebuilt from scratch.
+// Returns true if part of the tree was reused.
+bool tree_set_position(const Board& board);
+
 // Perform MCTS search and return best move
+// With options.threads > 1 the search is root-parallel: helper threads
+// search the same position on their own persistent trees (rollout streams
+// derived from rng_stream) and the move with the most root visits summed
+// over all trees is played. An iteration limit is split between the
+// threads; the calling thread's tree, statistics and on_info reports cover
+// its own share only, except search_stats.iterations, which is the total,
+// and root_stats/root_analysis after the search, which merge all trees.
+// Parallel searches from different threads run one at a time.
+// With limits.resume, a search of the same position as the previous one on
+// this thread continues it as the next slice of one longer search: the
+// tree, the rollout RNG state and search_stats carry on (iterations and
+// total_ms accumulate). The limits still apply per call. Otherwise resume
+// is ignored.
 int getBest(Board& board, int iters);
+int getBest(Board& board, const SearchLimits& limits);
+
+// Search like getBest and also return the top options.multipv root moves
+// (see root_analysis; summed over all trees with Threads > 1) in 'lines'.
+// lines[0] is the move returned. With multipv > 1 the search keeps every
+// one of them at a minimum share of the root visits of each tree, so their
+// win rates stay comparable.
+int getBest(Board& board, const SearchLimits& limits, std::vector<RootMove>& lines);
 
 // DFS function for MCTS
 // Returns result from black's perspective: 1.0 = black win, 0.0 = white win, 0.5 = draw
 double dfs(int node_id, int lst1, int lst2, Board& board);
 
+// Black's win probability from the pattern counts: 1 or 0 if the side to
+// move has a four, otherwise a logistic of the weighted count difference.
+// The board must track its patterns (Board::enable_patterns).
+double evaluate(const Board& board);
+
+// Round p to 0, 0.5 or 1 at random with mean p (node wins count half wins)
+double sample_half(double p, Rng& rng);
+
 // Rollout from current board state
-double rollout(Board board, int depth_limit = ROLLOUT_MAX_DEPTH);
+// If played is non-null, each rollout move is recorded in played[side].
+// With eval_cutoff, a rollout that reaches depth_limit scores evaluate()
+// instead of a draw, rounded at random to 0, 0.5 or 1 with that mean (node
+// statistics count half wins). The search passes boards that track their
+// patterns; others are counted from scratch first.
+double rollout(Board board, int depth_limit = ROLLOUT_MAX_DEPTH, lbit256* played = nullptr,
+               bool eval_cutoff = false);
+
+// Play 'lanes' (<= ROLLOUT_LANES) rollouts from board in lock-step and
+// return their mean result (black's perspective). With played non-null,
+// lane l records its moves in played[l][side]; with lane_wins non-null its
+// result goes to lane_wins[l] (black's, x2). eval_cutoff as in rollout
+// (lanes count their patterns from scratch at the cutoff).
+double rollout_batch(const Board& board, int lanes, int depth_limit = ROLLOUT_MAX_DEPTH,
+                     lbit256 (*played)[2] = nullptr, bool eval_cutoff = false, int* lane_wins = nullptr);
 
 // Scan threats for a given position
 // Returns the highest threat level move, populates move_list with all moves at that level
 int scan_threats(const Board& board, int last_move, int side, 
                  int* move_list, int& move_count, bool is_self);
 
+// Scan every line on the board for threats by 'player' (used at the root,
+// where there is no last move to scan around); same contract as scan_threats
+int scan_all_threats(const Board& board, int player,
+                     int* move_list, int& move_count, bool is_self);
+
+// Cheap move-ordering score for progressive widening: line patterns through
+// 'move' for both sides plus proximity to the last two moves (higher = better)
+int move_order_score(const Board& board, int move, int lst1, int lst2);
+
+// Keep one representative of each set of moves that are equivalent under the
+// symmetries preserved by the board (the lowest index in each orbit)
+lbit256 canonical_moves(const Board& board, lbit256 moves);
+
+// Random opening for self-play and matches: the first stone goes in the
+// central 5x5, later ones anywhere in board.nxt. Stops early instead of
+// playing a winning move. Moves played are appended to 'moves'.
+void random_opening(Board& board, Rng& rng, int plies, std::vector<int>& moves);
+
 #endif // SEARCH_H
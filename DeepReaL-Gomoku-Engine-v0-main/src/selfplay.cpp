@@ -0,0 +1,208 @@
+// ============================================================================
+// DeepReaL Gomoku Engine v0 - Headless self-play generator
+// Plays N games on a pool of threads (each thread owns its search tree),
+// starting from randomised openings, and streams finished games to a binary
+// record file (see gamerecord.h).
+//
+//   selfplay [--games N] [--threads T] [--iters N] [--movetime MS]
+//            [--opening PLIES] [--seed S] [--rollouts N] [--out FILE]
+//   selfplay --dump FILE     print a record file as text
+// ============================================================================
+
+#include "board.h"
+#include "search.h"
+#include "gamerecord.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+struct SelfplayConfig {
+    int games = 100;
+    int threads = 0;                // 0 = hardware concurrency
+    int iters = 10000;              // Per move (0 = only movetime)
+    int movetime_ms = 0;
+    int opening_plies = 4;          // Random moves before searching
+    uint64_t seed = ROLLOUT_SEED;   // Openings and rollout streams
+    string out = "selfplay.bin";
+};
+
+static SelfplayConfig cfg;
+static atomic<int> next_game(0);
+static mutex out_mutex;             // Guards out_file and the counters below
+static FILE* out_file = nullptr;
+static int games_done = 0;
+static int results[3] = {0, 0, 0}; // Indexed by GameRecord::result
+static chrono::steady_clock::time_point start_time;
+
+// Play one game. Rollout streams are derived from (game, ply), so a game's
+// moves don't depend on which thread plays it.
+static GameRecord play_game(uint32_t game_id) {
+    GameRecord rec;
+    rec.game_id = game_id;
+    
+    Rng rng;
+    rng.seed(cfg.seed, game_id);
+    Board board;
+    board.init();
+    vector<int> opening;
+    random_opening(board, rng, cfg.opening_plies, opening);
+    for (int m : opening) rec.moves.push_back({m, 0.5, 0, 0});
+    rec.opening_plies = board.cnt;
+    
+    // nxt is empty before the first stone; the search then plays the centre
+    while (!board.isTerminal() && (board.cnt == 0 || !board.nxt.empty())) {
+        SearchLimits limits;
+        limits.iters = cfg.iters;
+        limits.movetime_ms = cfg.movetime_ms;
+        limits.reuse_tree = board.cnt > rec.opening_plies;  // Never across games
+        limits.rng_stream = ((uint64_t)game_id << 8) | board.cnt;
+        int side = board.side();
+        int best = getBest(board, limits);
+        
+        MoveRecord m{best, 0.5, 0, 0};
+        const Node& root = nodes[tree_root];
+        if (root.visits > 0) {
+            double black = (double)root.wins / (2.0 * root.visits);
+            m.winrate = side == 0 ? black : 1.0 - black;
+            m.root_visits = root.visits;
+            for (int c = root.fst_child; c != -1; c = nodes[c].nxt_sib) {
+                if (nodes[c].move == best) m.best_visits = nodes[c].visits;
+            }
+        }
+        rec.moves.push_back(m);
+        board.set(best);
+    }
+    
+    rec.result = board.isTerminal() ? board.res : RECORD_DRAW;
+    return rec;
+}
+
+static const char* result_name(int result) {
+    return result == 1 ? "black" : result == 0 ? "white" : "draw";
+}
+
+static void worker() {
+    int game;
+    while ((game = next_game++) < cfg.games) {
+        GameRecord rec = play_game(game);
+        vector<uint8_t> bytes;
+        encode_game_record(rec, bytes);
+        
+        lock_guard<mutex> lock(out_mutex);
+        fwrite(bytes.data(), 1, bytes.size(), out_file);
+        fflush(out_file);
+        games_done++;
+        results[rec.result]++;
+        double secs = chrono::duration<double>(chrono::steady_clock::now() - start_time).count();
+        fprintf(stderr, "game %d (%d/%d): %s, %zu moves, %.1f games/min\n", game, games_done,
+                cfg.games, result_name(rec.result), rec.moves.size(), games_done * 60.0 / secs);
+    }
+}
+
+static int dump(const char* path) {
+    vector<GameRecord> games;
+    if (!read_record_file(path, games)) {
+        fprintf(stderr, "error: cannot read record file %s\n", path);
+        return 1;
+    }
+    for (const GameRecord& rec : games) {
+        printf("game %u result %s opening %d moves %zu:", rec.game_id, result_name(rec.result),
+               rec.opening_plies, rec.moves.size());
+        for (const MoveRecord& m : rec.moves) {
+            if (m.root_visits == 0) {
+                printf(" %d", m.move);
+            } else {
+                printf(" %d(%.3f/%u/%u)", m.move, m.winrate, m.best_visits, m.root_visits);
+            }
+        }
+        printf("\n");
+    }
+    return 0;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "usage: %s [--games N] [--threads T] [--iters N] [--movetime MS]\n"
+            "          [--opening PLIES] [--seed S] [--rollouts N] [--out FILE]\n"
+            "       %s --dump FILE\n", prog, prog);
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        const char* val = argv[++i];
+        if (arg == "--dump") {
+            return dump(val);
+        } else if (arg == "--games") {
+            cfg.games = atoi(val);
+        } else if (arg == "--threads") {
+            cfg.threads = atoi(val);
+        } else if (arg == "--iters") {
+            cfg.iters = atoi(val);
+        } else if (arg == "--movetime") {
+            cfg.movetime_ms = atoi(val);
+        } else if (arg == "--opening") {
+            cfg.opening_plies = atoi(val);
+        } else if (arg == "--seed") {
+            cfg.seed = strtoull(val, nullptr, 10);
+        } else if (arg == "--rollouts") {
+            if (!set_search_option("ROLLOUTS", val)) {
+                fprintf(stderr, "error: --rollouts must be 1-%d\n", ROLLOUT_LANES);
+                return 1;
+            }
+        } else if (arg == "--out") {
+            cfg.out = val;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (cfg.iters <= 0 && cfg.movetime_ms <= 0) {
+        fprintf(stderr, "error: need --iters or --movetime\n");
+        return 1;
+    }
+    if (cfg.opening_plies < 0 || cfg.opening_plies > 225) {
+        fprintf(stderr, "error: --opening must be 0-225\n");  // Stored as uint8
+        return 1;
+    }
+    if (cfg.threads <= 0) cfg.threads = max(1u, thread::hardware_concurrency());
+    cfg.threads = min(cfg.threads, max(1, cfg.games));
+    
+    init_precompute();
+    init_threat_tables();
+    
+    out_file = fopen(cfg.out.c_str(), "wb");
+    if (!out_file) {
+        fprintf(stderr, "error: cannot open %s\n", cfg.out.c_str());
+        return 1;
+    }
+    vector<uint8_t> header;
+    encode_record_header(header);
+    fwrite(header.data(), 1, header.size(), out_file);
+    
+    fprintf(stderr, "selfplay: %d games, %d threads, %d iters/move, %d ms/move -> %s\n",
+            cfg.games, cfg.threads, cfg.iters, cfg.movetime_ms, cfg.out.c_str());
+    start_time = chrono::steady_clock::now();
+    vector<thread> pool;
+    for (int t = 0; t < cfg.threads; t++) pool.emplace_back(worker);
+    for (thread& t : pool) t.join();
+    fclose(out_file);
+    
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start_time).count();
+    fprintf(stderr, "done: %d games in %.1f s (black %d, white %d, draw %d)\n",
+            games_done, secs, results[1], results[0], results[RECORD_DRAW]);
+    return 0;
+}
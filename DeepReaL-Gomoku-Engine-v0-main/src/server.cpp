@@ -0,0 +1,387 @@
+// ============================================================================
+// DeepReaL Gomoku Engine v0 - Multi-game server
+// ============================================================================
+
+#include "server.h"
+#include "board.h"
+#include "search.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+constexpr int ACCEPT_POLL_MS = 200;     // How often the accept loop checks *stop
+
+// A client connection. Replies come from its reader thread and from search
+// workers, so writes are serialised. The fd is closed with the last
+// reference: queued and running jobs hold one, so a reply can never reach a
+// later client that was given the same fd number.
+struct Connection {
+    int fd;
+    mutex write_mutex;
+    atomic<bool> done{false};   // Reader thread has finished
+
+    explicit Connection(int f) : fd(f) {}
+    ~Connection() { close(fd); }
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    // The socket has a send timeout (SO_SNDTIMEO): a client that went away
+    // or stopped reading is shut down, so later replies fail at once
+    void send(const string& line) {
+        lock_guard<mutex> lock(write_mutex);
+        string msg = line + "\n";
+        size_t sent = 0;
+        while (sent < msg.size()) {
+            ssize_t n = ::send(fd, msg.data() + sent, msg.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) {
+                shutdown(fd, SHUT_RDWR);
+                return;
+            }
+            sent += n;
+        }
+    }
+};
+
+struct Session {
+    Board board;
+    bool searching = false;     // A go request is queued or running
+    const Connection* owner = nullptr;  // Dropped when this connection closes
+};
+
+struct Job {
+    shared_ptr<Connection> conn;
+    string id;
+    Board board;
+    int iters;
+    int movetime_ms;
+    Clock::time_point deadline;  // Clock::time_point::max() = none
+};
+
+// Server state (one server per process at a time)
+static ServerConfig g_cfg;
+static mutex g_sessions_mutex;
+static unordered_map<string, Session> g_sessions;
+static mutex g_queue_mutex;
+static condition_variable g_queue_cv;
+static deque<Job> g_queue;
+static int g_in_flight = 0;             // Searches queued or running
+static bool g_shutdown = false;
+static atomic<bool> g_stop_searches(false);
+
+// ============================================================================
+// Search workers
+// ============================================================================
+static void finish_job(const Job& job, const string& reply) {
+    {
+        lock_guard<mutex> lock(g_queue_mutex);
+        g_in_flight--;
+    }
+    {
+        lock_guard<mutex> lock(g_sessions_mutex);
+        auto it = g_sessions.find(job.id);
+        if (it != g_sessions.end()) it->second.searching = false;
+    }
+    job.conn->send(reply);
+}
+
+static void search_worker() {
+    while (true) {
+        Job job;
+        {
+            unique_lock<mutex> lock(g_queue_mutex);
+            g_queue_cv.wait(lock, []() { return g_shutdown || !g_queue.empty(); });
+            if (g_shutdown) return;
+            job = move(g_queue.front());
+            g_queue.pop_front();
+        }
+
+        SearchLimits limits;
+        limits.iters = job.iters;
+        limits.movetime_ms = job.movetime_ms;
+        limits.stop = &g_stop_searches;
+        limits.reuse_tree = true;  // Only reused when the position continues this worker's tree
+        if (job.deadline != Clock::time_point::max()) {
+            auto left = chrono::duration_cast<chrono::milliseconds>(job.deadline - Clock::now()).count();
+            if (left <= 0) {
+                finish_job(job, "error " + job.id + " deadline");
+                continue;
+            }
+            limits.movetime_ms = limits.movetime_ms > 0 ? min<long long>(limits.movetime_ms, left) : left;
+        }
+
+        int side = job.board.side();
+        int best = getBest(job.board, limits);
+        // Summed over all trees with Threads > 1, like the choice of 'best'
+        RootStats root;
+        root_stats(root);
+        int visits = best >= 0 ? root.child_visits[best] : 0;
+        double winrate = 0.5;
+        if (root.visits > 0) {
+            double black = (double)root.wins / (2.0 * root.visits);
+            winrate = side == 0 ? black : 1.0 - black;
+        }
+        char buf[160];
+        snprintf(buf, sizeof(buf), " %d visits %d winrate %.4f time %d", best, visits, winrate,
+                 (int)search_stats.total_ms);
+        finish_job(job, "bestmove " + job.id + buf);
+    }
+}
+
+// ============================================================================
+// Commands
+// ============================================================================
+// Queue a search for session 'id'; returns the immediate reply (empty if
+// the reply comes from the worker)
+static string queue_search(const shared_ptr<Connection>& conn, const string& id, istringstream& iss) {
+    Job job;
+    job.conn = conn;
+    job.id = id;
+    job.iters = g_cfg.iters;
+    job.movetime_ms = g_cfg.movetime_ms;
+    int deadline_ms = g_cfg.deadline_ms;
+    bool has_iters = false, has_time = false;
+    string arg;
+    while (iss >> arg) {
+        if (arg == "iters") iss >> job.iters, has_iters = true;
+        else if (arg == "movetime") iss >> job.movetime_ms, has_time = true;
+        else if (arg == "deadline") iss >> deadline_ms;
+        else return "error " + id + " invalid argument " + arg;
+    }
+    if (has_time && !has_iters) job.iters = 0;
+    if (job.iters <= 0 && job.movetime_ms <= 0 && deadline_ms <= 0) {
+        return "error " + id + " unbounded search";
+    }
+    job.deadline = deadline_ms > 0 ? Clock::now() + chrono::milliseconds(deadline_ms)
+                                   : Clock::time_point::max();
+
+    lock_guard<mutex> sessions_lock(g_sessions_mutex);
+    auto it = g_sessions.find(id);
+    if (it == g_sessions.end()) return "error " + id + " unknown session";
+    Session& session = it->second;
+    if (session.searching) return "error " + id + " search in progress";
+    if (session.board.isTerminal()) return "error " + id + " game already ended";
+    {
+        lock_guard<mutex> queue_lock(g_queue_mutex);
+        if (g_in_flight >= g_cfg.workers + g_cfg.queue_size) return "busy " + id;
+        job.board = session.board;
+        session.searching = true;
+        g_queue.push_back(move(job));
+        g_in_flight++;
+    }
+    g_queue_cv.notify_one();
+    return "";
+}
+
+// Handle one command line; returns false when the client quits
+static bool handle_command(const shared_ptr<Connection>& conn, const string& line) {
+    istringstream iss(line);
+    string cmd, id;
+    iss >> cmd >> id;
+    if (cmd.empty()) return true;
+    if (cmd == "quit") return false;
+    if (cmd == "status") {
+        size_t sessions, queued, running;
+        {
+            lock_guard<mutex> lock(g_sessions_mutex);
+            sessions = g_sessions.size();
+        }
+        {
+            lock_guard<mutex> lock(g_queue_mutex);
+            queued = g_queue.size();
+            running = g_in_flight - queued;
+        }
+        conn->send("status sessions " + to_string(sessions) + " running " + to_string(running) +
+                   " queued " + to_string(queued) + " workers " + to_string(g_cfg.workers));
+        return true;
+    }
+    if (id.empty()) {
+        conn->send("error missing session id");
+        return true;
+    }
+
+    string reply;
+    if (cmd == "go") {
+        reply = queue_search(conn, id, iss);
+    } else {
+        lock_guard<mutex> lock(g_sessions_mutex);
+        auto it = g_sessions.find(id);
+        if (cmd == "new") {
+            if (it != g_sessions.end() && it->second.searching) {
+                reply = "error " + id + " search in progress";
+            } else {
+                Session& session = g_sessions[id];
+                session.board.init();
+                session.owner = conn.get();
+                reply = "ok " + id;
+            }
+        } else if (it == g_sessions.end()) {
+            reply = "error " + id + " unknown session";
+        } else if (it->second.searching) {
+            reply = "error " + id + " search in progress";
+        } else if (cmd == "update") {
+            Board& board = it->second.board;
+            int move = -1;
+            iss >> move;
+            if (move >= 0 && move < 225 && !board.isTerminal() && !board.b[0].get(move) &&
+                !board.b[1].get(move)) {
+                board.set(move);
+                reply = "ok " + id;
+            } else {
+                reply = "error " + id + " invalid move";
+            }
+        } else if (cmd == "close") {
+            g_sessions.erase(it);
+            reply = "ok " + id;
+        } else {
+            reply = "error " + id + " unknown command " + cmd;
+        }
+    }
+    if (!reply.empty()) conn->send(reply);
+    return true;
+}
+
+static void connection_reader(shared_ptr<Connection> conn) {
+    string pending;
+    char buf[4096];
+    bool open = true;
+    while (open) {
+        ssize_t n = recv(conn->fd, buf, sizeof(buf), 0);
+        if (n <= 0) break;
+        pending.append(buf, n);
+        size_t start = 0, nl;
+        while (open && (nl = pending.find('\n', start)) != string::npos) {
+            string line = pending.substr(start, nl - start);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            open = handle_command(conn, line);
+            start = nl + 1;
+        }
+        pending.erase(0, start);
+    }
+    shutdown(conn->fd, SHUT_RDWR);
+    {
+        // A running search of a dropped session still replies (to nobody)
+        lock_guard<mutex> lock(g_sessions_mutex);
+        for (auto it = g_sessions.begin(); it != g_sessions.end();) {
+            it = it->second.owner == conn.get() ? g_sessions.erase(it) : next(it);
+        }
+    }
+    conn->done = true;
+}
+
+// ============================================================================
+// Listener
+// ============================================================================
+static int open_listener(const ServerConfig& cfg) {
+    int fd;
+    if (!cfg.socket_path.empty()) {
+        sockaddr_un addr{};
+        if (cfg.socket_path.size() >= sizeof(addr.sun_path)) return -1;
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) return -1;
+        addr.sun_family = AF_UNIX;
+        strcpy(addr.sun_path, cfg.socket_path.c_str());
+        unlink(cfg.socket_path.c_str());
+        if (bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            close(fd);
+            return -1;
+        }
+    } else {
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) return -1;
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(cfg.port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            close(fd);
+            return -1;
+        }
+    }
+    if (listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int run_server(const ServerConfig& cfg, const atomic<bool>* stop) {
+    g_cfg = cfg;
+    if (g_cfg.workers <= 0) g_cfg.workers = max(1u, thread::hardware_concurrency());
+    g_cfg.queue_size = max(1, g_cfg.queue_size);
+    g_sessions.clear();
+    g_queue.clear();
+    g_in_flight = 0;
+    g_shutdown = false;
+    g_stop_searches = false;
+
+    int listen_fd = open_listener(g_cfg);
+    if (listen_fd < 0) return 1;
+
+    vector<thread> workers;
+    for (int i = 0; i < g_cfg.workers; i++) workers.emplace_back(search_worker);
+
+    struct Client {
+        shared_ptr<Connection> conn;
+        thread reader;
+    };
+    vector<Client> clients;
+    while (!stop || !*stop) {
+        pollfd pfd{listen_fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, ACCEPT_POLL_MS);
+
+        // Reap finished connections (the fd stays open while jobs hold it)
+        for (size_t i = 0; i < clients.size();) {
+            if (clients[i].conn->done) {
+                clients[i].reader.join();
+                clients[i] = move(clients.back());
+                clients.pop_back();
+            } else {
+                i++;
+            }
+        }
+        if (ready <= 0) continue;
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) continue;
+        timeval timeout{g_cfg.send_timeout_ms / 1000, (g_cfg.send_timeout_ms % 1000) * 1000};
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        auto conn = make_shared<Connection>(fd);
+        clients.push_back({conn, thread(connection_reader, conn)});
+    }
+
+    close(listen_fd);
+    if (!g_cfg.socket_path.empty()) unlink(g_cfg.socket_path.c_str());
+    {
+        lock_guard<mutex> lock(g_queue_mutex);
+        g_shutdown = true;
+        g_queue.clear();
+    }
+    g_stop_searches = true;
+    g_queue_cv.notify_all();
+    for (thread& t : workers) t.join();
+    for (Client& c : clients) {
+        shutdown(c.conn->fd, SHUT_RDWR);
+        c.reader.join();
+    }
+    return 0;
+}
@@ -0,0 +1,48 @@
+// ============================================================================
+// DeepReaL Gomoku Engine v0 - Multi-game server
+// Serves many games from one process over a Unix domain or TCP socket.
+// Games are sessions keyed by a client-chosen ID; searches from all
+// connections go through one bounded queue to a fixed pool of search
+// workers, each reusing its own node pool between requests.
+//
+// Line protocol (one command per line, replies carry the session ID):
+//   new <id>                    -> ok <id>            start or restart a game
+//   update <id> <move>          -> ok <id>            play a move
+//   go <id> [iters N] [movetime MS] [deadline MS]
+//                               -> bestmove <id> <move> visits <n> winrate <p> time <ms>
+//                                  (later; replies to concurrent requests may come
+//                                  in any order)
+//                               -> busy <id>          search queue full, retry later
+//   close <id>                  -> ok <id>            forget the game
+//   status                      -> status sessions <n> running <n> queued <n> workers <n>
+//   quit                                              close the connection
+// Errors are reported as "error <id> <reason>". A search whose deadline
+// passes while it waits in the queue is dropped with "error <id> deadline";
+// a running search is cut off at its deadline. A session belongs to the
+// connection that last sent "new" for it and is dropped when that
+// connection closes. A client that does not read its replies for
+// send_timeout_ms is disconnected.
+// ============================================================================
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <atomic>
+#include <string>
+
+struct ServerConfig {
+    std::string socket_path;    // Unix domain socket path (used if non-empty)
+    int port = 0;               // Otherwise TCP port on 127.0.0.1
+    int workers = 0;            // Search threads (0 = hardware concurrency)
+    int queue_size = 64;        // Searches waiting for a busy worker before "busy"
+    int iters = 10000;          // Default go limits
+    int movetime_ms = 0;
+    int deadline_ms = 0;        // Default per-request deadline (0 = none)
+    int send_timeout_ms = 5000; // Longest a reply may block on a full socket
+};
+
+// Serve until *stop is set (polled a few times per second) or forever if
+// stop is null. Returns 0 after a clean stop, 1 if the socket cannot be set up.
+int run_server(const ServerConfig& cfg, const std::atomic<bool>* stop = nullptr);
+
+#endif // SERVER_H
@@ -1,10 +1,24 @@
 #include "board.h"
 #include "search.h"
+#include "bench.h"
+#include "gamerecord.h"
+#include "analyze.h"
+#include "server.h"
+#include "game.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <chrono>
 #include <cassert>
+#include <atomic>
 #include <vector>
 #include <set>
+#include <thread>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 
 using namespace std;
 
@@ -770,6 +784,946 @@ bool test_search_performance() {
     }
 }
 
+// Test: RAVE-enabled search still finds forced wins and blocks
+bool test_search_rave() {
+    cout << "\nTest Search RAVE: AMAF blending keeps tactics..." << endl;
+    
+    search_options.rave = true;
+    
+    // Black has XXXX. on row 5 (79-82), White has XXX on row 9 (139-141)
+    Board board;
+    board.init();
+    board.set(79);  board.set(139);
+    board.set(80);  board.set(140);
+    board.set(81);  board.set(141);
+    board.set(82);                    // White to move, must block 78 or 83
+    
+    int best_o = getBest(board, 2000);
+    
+    // Black to move in the .XXXX. position -> must complete five
+    Board board2;
+    board2.init();
+    board2.set(111); board2.set(0);
+    board2.set(112); board2.set(32);
+    board2.set(113); board2.set(64);
+    board2.set(114); board2.set(96);
+    
+    int best_x = getBest(board2, 2000);
+    
+    search_options.rave = false;
+    
+    bool passed = (best_o == 78 || best_o == 83) && (best_x == 110 || best_x == 115);
+    if (passed) {
+        cout << "  PASS: O blocks at " << best_o << ", X wins at " << best_x << endl;
+    } else {
+        cout << "  FAIL: O played " << best_o << " (expected 78/83), X played " << best_x << " (expected 110/115)" << endl;
+    }
+    return passed;
+}
+
+// Test: Persistent tree keeps the subtree of the moves actually played
+bool test_tree_reuse() {
+    cout << "\nTest Tree Reuse: subtree kept across moves..." << endl;
+    
+    Board board;
+    board.init();
+    board.set(112); board.set(113);
+    
+    SearchLimits limits;
+    limits.iters = 5000;
+    limits.reuse_tree = true;
+    int best = getBest(board, limits);
+    
+    // Most-visited reply to our move: its subtree should survive
+    int our_node = -1;
+    for (int c = nodes[tree_root].fst_child; c != -1; c = nodes[c].nxt_sib) {
+        if (nodes[c].move == best) our_node = c;
+    }
+    int reply = -1, reply_visits = -1;
+    for (int c = nodes[our_node].fst_child; c != -1; c = nodes[c].nxt_sib) {
+        if (nodes[c].visits > reply_visits) {
+            reply_visits = nodes[c].visits;
+            reply = nodes[c].move;
+        }
+    }
+    
+    Board start = board;
+    int start_visits = nodes[tree_root].visits;
+    board.set(best);
+    board.set(reply);
+    bool reused = tree_set_position(board);
+    bool kept = reused && nodes[tree_root].visits == reply_visits;
+    
+    // Taking both moves back returns to the original root
+    bool back = tree_set_position(start) && nodes[tree_root].visits == start_visits;
+    kept = kept && back;
+    
+    // An unrelated position must rebuild the tree
+    Board other;
+    other.init();
+    other.set(0);
+    bool rebuilt = !tree_set_position(other) && nodes[tree_root].visits == 0;
+    
+    if (kept && rebuilt) {
+        cout << "  PASS: Reused subtree with " << reply_visits << " visits" << endl;
+        return true;
+    }
+    cout << "  FAIL: reused=" << reused << ", taken back=" << back << ", root visits="
+         << nodes[tree_root].visits << " (expected " << reply_visits << "), rebuilt=" << rebuilt << endl;
+    return false;
+}
+
+// Test: position/takeback game state used by the UCI and WASM front ends
+bool test_game_state() {
+    cout << "\nTest Game State: position and takeback..." << endl;
+    
+    GameState game;
+    game.reset();
+    auto apply = [&](const string& args) {
+        istringstream iss(args);
+        return game.set_position(iss);
+    };
+    
+    bool moves_ok = apply("startpos moves 112 113 127") == "" && game.board.cnt == 3 &&
+                    game.moves.size() == 3 && game.board.side() == 1;
+    bool illegal = apply("startpos moves 112 112") != "" && game.board.cnt == 3;  // Unchanged
+    bool back = game.takeback(2) && game.board.cnt == 1 && game.board.b[0].get(112) &&
+                !game.board.b[1].get(113) && !game.takeback(2);
+    
+    string cells(225, '.');
+    cells[112] = 'X'; cells[113] = 'O'; cells[127] = 'X';
+    bool loaded = apply("board " + cells + " side w moves 128") == "" && game.board.cnt == 4 &&
+                  game.base.cnt == 3 && game.takeback(1) && game.board.cnt == 3 &&
+                  !game.takeback(1);
+    bool wrong_side = apply("board " + cells + " side b") != "";
+    bool play_ok = game.play(98) && !game.play(98) && game.board.last_move == 98;
+    
+    // takeback command arguments: a count of at least 1, default 1
+    auto take = [&](const string& args) {
+        istringstream iss(args);
+        return game.takeback(iss);
+    };
+    bool parsed = take("foo") != "" && take("0") != "" && take("-1") != "" && take("5") != "" &&
+                  game.board.cnt == 4 && take("") == "" && game.board.cnt == 3 &&
+                  apply("startpos moves 112 113 127") == "" && take(" 2") == "" && game.board.cnt == 1;
+    
+    if (moves_ok && illegal && back && loaded && wrong_side && play_ok && parsed) {
+        cout << "  PASS: positions applied at once, takeback replays history" << endl;
+        return true;
+    }
+    cout << "  FAIL: moves=" << moves_ok << ", illegal=" << illegal << ", takeback=" << back
+         << ", board=" << loaded << ", wrong side=" << wrong_side << ", play=" << play_ok
+         << ", takeback args=" << parsed << endl;
+    return false;
+}
+
+// Test: lock-step batch rollouts play the same game distribution as rollout()
+bool test_rollout_batch() {
+    cout << "\nTest Rollout Batch: matches scalar rollouts..." << endl;
+    
+    Board board;
+    board.init();
+    board.set(112); board.set(113);
+    board.set(126); board.set(98);
+    
+    const int games = 8000;
+    double scalar = 0, batched = 0;
+    rollout_rng.seed(1);
+    for (int i = 0; i < games; i++) scalar += rollout(board);
+    for (int i = 0; i < games / ROLLOUT_LANES; i++) batched += rollout_batch(board, ROLLOUT_LANES);
+    scalar /= games;
+    batched /= games / ROLLOUT_LANES;
+    
+    // Finished positions score the result in every lane
+    Board won = board;
+    won.set(127); won.set(0); won.set(128); won.set(1);
+    won.set(129); won.set(2); won.set(130); won.set(3);
+    won.set(131);
+    bool terminal_ok = rollout_batch(won, 4) == 1.0;
+    
+    // Each lane reports its own moves and result
+    lbit256 played[ROLLOUT_LANES][2];
+    int lane_wins[ROLLOUT_LANES];
+    double mean = rollout_batch(board, ROLLOUT_LANES, ROLLOUT_MAX_DEPTH, played, false, lane_wins);
+    int total = 0;
+    bool lanes_ok = true;
+    for (int l = 0; l < ROLLOUT_LANES; l++) {
+        total += lane_wins[l];
+        int diff = played[l][0].popcount() - played[l][1].popcount();
+        lanes_ok = lanes_ok && diff >= 0 && diff <= 1 && (played[l][0] & played[l][1]).empty() &&
+                   ((played[l][0] | played[l][1]) & (board.b[0] | board.b[1])).empty();
+    }
+    lanes_ok = lanes_ok && total == (int)lround(mean * 2 * ROLLOUT_LANES);
+    
+    // One iteration adds ROLLOUTS visits along its path
+    search_options.rollouts = ROLLOUT_LANES;
+    SearchLimits limits;
+    limits.iters = 500;
+    getBest(board, limits);
+    bool visits_ok = nodes[tree_root].visits == 500 * ROLLOUT_LANES;
+    
+    // With RAVE, a move played in only some lanes gets one AMAF visit per lane
+    search_options.rave = true;
+    getBest(board, limits);
+    bool rave_ok = false;
+    for (int c = nodes[tree_root].fst_child; c != -1; c = nodes[c].nxt_sib) {
+        if (nodes[c].rave_visits % ROLLOUT_LANES != 0) rave_ok = true;
+    }
+    search_options.rave = false;
+    search_options.rollouts = 1;
+    
+    bool close = fabs(scalar - batched) < 0.03;
+    if (close && terminal_ok && visits_ok && lanes_ok && rave_ok) {
+        cout << "  PASS: mean result " << scalar << " scalar vs " << batched << " batched" << endl;
+        return true;
+    }
+    cout << "  FAIL: scalar " << scalar << ", batched " << batched << ", terminal_ok=" << terminal_ok
+         << ", visits_ok=" << visits_ok << ", lanes_ok=" << lanes_ok << ", rave_ok=" << rave_ok << endl;
+    return false;
+}
+
+// Test: Board::set keeps the pattern counts equal to a full recount, and
+// truncated rollouts score them
+bool test_pattern_eval() {
+    cout << "\nTest Pattern Eval: incremental counts and truncated rollouts..." << endl;
+    
+    // Random games: incremental counts match count_patterns after every move
+    Rng rng;
+    rng.seed(7);
+    int mismatches = 0, moves = 0;
+    for (int game = 0; game < 200; game++) {
+        Board board;
+        board.init();
+        board.set(112);
+        board.enable_patterns();
+        while (!board.isTerminal() && !board.nxt.empty()) {
+            lbit256 legal = board.nxt;
+            int target = (int)(rng.next() % legal.popcount());
+            int move = -1;
+            for (int i = 0; i <= target; i++) move = legal.popbit();
+            board.set(move);
+            moves++;
+            uint64_t full[2];
+            board.count_patterns(full);
+            if (full[0] != board.pat[0] || full[1] != board.pat[1]) mismatches++;
+        }
+    }
+    
+    // An open three in the middle of a row lies in three open-three windows;
+    // a four for the side to move is a win
+    Board three;
+    three.init();
+    three.enable_patterns();
+    three.set(112); three.set(0);
+    three.set(113); three.set(14);
+    three.set(114); three.set(210);
+    bool three_ok = three.pattern_count(0, PAT_OPEN_THREE) == 3 && three.pattern_count(0, PAT_FOUR) == 0 &&
+                    evaluate(three) > 0.5;
+    Board four = three;
+    four.set(115);
+    four.set(224);
+    bool four_ok = four.pattern_count(0, PAT_OPEN_FOUR) + four.pattern_count(0, PAT_FOUR) > 0 &&
+                   evaluate(four) == 1.0;
+    
+    // Truncated rollouts: counted as cutoffs, results in half-win steps
+    Board board;
+    board.init();
+    board.set(112); board.set(113);
+    board.set(126); board.set(98);
+    search_stats = SearchStats();
+    double sum = 0, batched = 0;
+    bool steps_ok = true;
+    for (int i = 0; i < 2000; i++) {
+        double r = rollout(board, 6, nullptr, true);
+        if (r != 0.0 && r != 0.5 && r != 1.0) steps_ok = false;
+        sum += r;
+    }
+    long long cutoffs = search_stats.rollout_results[ROLLOUT_CUTOFF];
+    for (int i = 0; i < 2000 / ROLLOUT_LANES; i++) batched += rollout_batch(board, ROLLOUT_LANES, 6, nullptr, true);
+    sum /= 2000;
+    batched /= 2000 / ROLLOUT_LANES;
+    bool rollout_ok = steps_ok && cutoffs > 1500 && fabs(sum - batched) < 0.05;
+    
+    bool ok = mismatches == 0 && three_ok && four_ok && rollout_ok;
+    if (ok) {
+        cout << "  PASS: " << moves << " moves with matching counts, 6-ply rollouts score "
+             << sum << " (batched " << batched << ")" << endl;
+        return true;
+    }
+    cout << "  FAIL: mismatches=" << mismatches << ", three=" << three_ok << ", four=" << four_ok
+         << ", rollouts " << sum << " / " << batched << " cutoffs " << cutoffs << endl;
+    return false;
+}
+
+// Root child visit counts after a fresh search (identifies the search tree)
+static vector<int> root_visits(Board board, int iters, uint64_t stream,
+                               const SearchOptions* options = nullptr) {
+    SearchLimits limits;
+    limits.iters = iters;
+    limits.rng_stream = stream;
+    limits.options = options;
+    getBest(board, limits);
+    vector<int> visits;
+    for (int c = nodes[tree_root].fst_child; c != -1; c = nodes[c].nxt_sib) {
+        visits.push_back(nodes[c].visits);
+    }
+    return visits;
+}
+
+// Test: searches are reproducible for a given seed and stream
+bool test_search_seed() {
+    cout << "\nTest Search Seed: reproducible rollouts..." << endl;
+    
+    Board board;
+    board.init();
+    board.set(84);  board.set(14);
+    board.set(85);  board.set(194);
+    board.set(112);
+    
+    uint64_t saved = search_options.seed;
+    vector<int> first = root_visits(board, 2000, 0);
+    vector<int> again = root_visits(board, 2000, 0);
+    vector<int> stream = root_visits(board, 2000, 1);
+    set_search_option("SEED", "42");
+    vector<int> seeded = root_visits(board, 2000, 0);
+    search_options.seed = saved;
+    
+    bool same = first == again;
+    bool differ = first != stream && first != seeded;
+    if (same && differ) {
+        cout << "  PASS: same seed repeats, other seed/stream differs" << endl;
+        return true;
+    }
+    cout << "  FAIL: repeat identical=" << same << ", other seed/stream differs=" << differ << endl;
+    return false;
+}
+
+// Test: threads search independently (per-thread pools and trees)
+bool test_concurrent_search() {
+    cout << "\nTest Concurrent Search: per-thread trees..." << endl;
+    
+    Board board;
+    board.init();
+    board.set(112); board.set(113);
+    board.set(126);
+    
+    vector<int> expected = root_visits(board, 2000, 7);
+    vector<int> got[2];
+    thread a([&]() { got[0] = root_visits(board, 2000, 7); });
+    thread b([&]() { got[1] = root_visits(board, 2000, 7); });
+    a.join();
+    b.join();
+    
+    if (got[0] == expected && got[1] == expected) {
+        cout << "  PASS: both threads reproduced the single-thread tree" << endl;
+        return true;
+    }
+    cout << "  FAIL: concurrent searches differ from the single-thread search" << endl;
+    return false;
+}
+
+// Test: root-parallel search splits the iterations and finds the tactics
+bool test_parallel_search() {
+    cout << "\nTest Parallel Search: root-parallel threads..." << endl;
+    
+    Board win;
+    win.init();
+    win.set(111); win.set(0);
+    win.set(112); win.set(32);
+    win.set(113); win.set(64);
+    win.set(114); win.set(96);
+    
+    Board quiet;
+    quiet.init();
+    quiet.set(112); quiet.set(113);
+    quiet.set(126);
+    
+    SearchOptions parallel;
+    bool parsed = set_search_option(parallel, "Threads", "4") &&
+                  !set_search_option(parallel, "Threads", "0") &&
+                  !set_search_option(parallel, "Threads", "65");
+    SearchLimits limits;
+    limits.iters = 4000;
+    limits.options = &parallel;
+    
+    int win_move = getBest(win, limits);
+    int first = getBest(quiet, limits);
+    int total = search_stats.iterations;
+    int own = nodes[tree_root].visits;
+    int second = getBest(quiet, limits);
+    
+    // Root statistics and analysis after the search cover all four trees
+    RootStats merged;
+    root_stats(merged);
+    vector<RootMove> lines;
+    root_analysis(lines);
+    long long line_visits = 0;
+    for (const RootMove& rm : lines) line_visits += rm.visits;
+    bool merged_ok = merged.visits == 4000 && !lines.empty() && lines[0].move == second &&
+                     lines[0].visits == merged.child_visits[second] && line_visits > 1001;
+    
+    bool ok = parsed && parallel.threads == 4 && (win_move == 110 || win_move == 115) &&
+              total == 4000 && own <= 1001 && first == second && merged_ok &&
+              !quiet.b[0].get(first) && !quiet.b[1].get(first);
+    if (ok) {
+        cout << "  PASS: 4 threads x 1000 iterations, best move " << first << endl;
+        return true;
+    }
+    cout << "  FAIL: parsed=" << parsed << ", win move=" << win_move << ", iterations=" << total
+         << ", own root visits=" << own << ", moves " << first << "/" << second
+         << ", merged root visits=" << merged.visits << endl;
+    return false;
+}
+
+// Test: SearchLimits::options applies to one search only
+bool test_search_options() {
+    cout << "\nTest Search Options: per-search overrides..." << endl;
+    
+    Board board;
+    board.init();
+    board.set(112); board.set(113);
+    board.set(126);
+    
+    SearchOptions defaults;
+    SearchOptions tuned;
+    bool parsed = set_search_option(tuned, "MCTS_C", "0.5") &&
+                  set_search_option(tuned, "ROLLOUT_DEPTH", "30");
+    bool rejected = !set_search_option(tuned, "MCTS_C", "0") &&
+                    !set_search_option(tuned, "ROLLOUT_DEPTH", "0") &&
+                    !set_search_option(tuned, "ROLLOUT_DEPTH", "300");
+    
+    vector<int> global = root_visits(board, 2000, 0);
+    vector<int> same = root_visits(board, 2000, 0, &defaults);
+    vector<int> other = root_visits(board, 2000, 0, &tuned);
+    vector<int> after = root_visits(board, 2000, 0);
+    
+    bool ok = parsed && rejected && tuned.c == 0.5 && tuned.rollout_depth == 30 &&
+              global == same && global != other && global == after &&
+              search_options.c == MCTS_C;
+    if (ok) {
+        cout << "  PASS: overrides change only their own search" << endl;
+        return true;
+    }
+    cout << "  FAIL: parsed=" << parsed << ", rejected=" << rejected << ", defaults match="
+         << (global == same) << ", tuned differs=" << (global != other)
+         << ", globals kept=" << (global == after) << endl;
+    return false;
+}
+
+// Test: a search stopped before it starts still returns a legal move
+bool test_search_stop() {
+    cout << "\nTest Search Stop: stop before the first iteration..." << endl;
+    
+    Board board;
+    board.init();
+    board.set(112); board.set(113);
+    board.set(126);
+    
+    atomic<bool> stop(true);
+    SearchLimits limits;  // No iteration or time limit: only the stop flag ends it
+    limits.stop = &stop;
+    int single = getBest(board, limits);
+    long long single_iters = search_stats.iterations;
+    
+    SearchOptions parallel;
+    set_search_option(parallel, "Threads", "2");
+    limits.options = &parallel;
+    int both = getBest(board, limits);
+    
+    bool ok = board.legal(single) && single_iters == 1 && board.legal(both) && search_stats.iterations == 2;
+    if (ok) {
+        cout << "  PASS: moves " << single << "/" << both << " after one iteration per thread" << endl;
+        return true;
+    }
+    cout << "  FAIL: moves " << single << "/" << both << ", iterations " << single_iters << "/"
+         << search_stats.iterations << endl;
+    return false;
+}
+
+// Test: a search resumed in slices grows the same tree as one long search
+bool test_search_resume() {
+    cout << "\nTest Search Resume: sliced search..." << endl;
+    
+    Board board;
+    board.init();
+    board.set(112); board.set(113);
+    board.set(126);
+    
+    vector<int> whole = root_visits(board, 3000, 0);
+    
+    SearchLimits limits;
+    limits.iters = 1000;
+    getBest(board, limits);
+    limits.resume = true;
+    getBest(board, limits);
+    getBest(board, limits);
+    long long sliced_iters = search_stats.iterations;
+    vector<int> sliced;
+    for (int c = nodes[tree_root].fst_child; c != -1; c = nodes[c].nxt_sib) {
+        sliced.push_back(nodes[c].visits);
+    }
+    
+    // Another position starts a new search
+    Board other = board;
+    other.set(98);
+    getBest(other, limits);
+    long long other_iters = search_stats.iterations;
+    
+    bool ok = sliced == whole && sliced_iters == 3000 && other_iters == 1000 &&
+              nodes[tree_root].visits == 1000;
+    if (ok) {
+        cout << "  PASS: 3 x 1000 iterations match one 3000-iteration search" << endl;
+        return true;
+    }
+    cout << "  FAIL: trees match=" << (sliced == whole) << ", iterations=" << sliced_iters
+         << ", new position iterations=" << other_iters << endl;
+    return false;
+}
+
+// Test: root analysis lists the root moves by visits with their PVs
+bool test_root_analysis() {
+    cout << "\nTest Root Analysis: per-move statistics..." << endl;
+    
+    Board board;
+    board.init();
+    board.set(112); board.set(113);
+    board.set(126);
+    
+    SearchInfo last;
+    int reports = 0;
+    SearchLimits limits;
+    limits.iters = 3000;
+    limits.analysis = 5;
+    limits.on_info = [&](const SearchInfo& info) {
+        last = info;
+        reports++;
+    };
+    int best = getBest(board, limits);
+    
+    vector<RootMove> all;
+    root_analysis(all);
+    long long sum = 0;
+    bool sorted = true, pv_ok = true;
+    for (size_t i = 0; i < all.size(); i++) {
+        sum += all[i].visits;
+        if (i > 0 && all[i].visits > all[i - 1].visits) sorted = false;
+        if (all[i].pv.empty() || all[i].pv[0] != all[i].move) pv_ok = false;
+        if (all[i].winrate < 0.0 || all[i].winrate > 1.0) pv_ok = false;
+    }
+    bool report_ok = reports > 0 && last.moves.size() == 5 && last.pv == all[0].pv &&
+                     last.moves[0].move == best && last.moves[4].visits == all[4].visits;
+    string line = root_move_line(all[0]);
+    bool line_ok = line.compare(0, 5 + to_string(best).size(), "move " + to_string(best)) == 0 &&
+                   line.find(" pv " + to_string(best)) != string::npos;
+    
+    bool ok = !all.empty() && all[0].move == best && sorted && pv_ok &&
+              sum <= nodes[tree_root].visits && report_ok && line_ok;
+    if (ok) {
+        cout << "  PASS: " << all.size() << " root moves, best " << best << " with "
+             << all[0].visits << " visits" << endl;
+        return true;
+    }
+    cout << "  FAIL: moves=" << all.size() << ", sorted=" << sorted << ", pv=" << pv_ok
+         << ", report=" << report_ok << ", line=" << line_ok << endl;
+    return false;
+}
+
+// Test: MultiPV keeps a visit floor on the top K root moves
+bool test_multipv() {
+    cout << "\nTest MultiPV: visit share of the top root moves..." << endl;
+    
+    Board board;
+    board.init();
+    board.set(112); board.set(113);
+    board.set(126); board.set(98);
+    
+    SearchOptions options;
+    bool parsed = set_search_option(options, "MultiPV", "4") &&
+                  !set_search_option(options, "MultiPV", "0") &&
+                  !set_search_option(options, "MultiPV", "226");
+    SearchLimits limits;
+    limits.iters = 5000;
+    limits.options = &options;
+    vector<RootMove> lines;
+    int best = getBest(board, limits, lines);
+    int root_visits = nodes[tree_root].visits;
+    
+    SearchOptions single;
+    limits.options = &single;
+    vector<RootMove> single_lines;
+    getBest(board, limits, single_lines);
+    vector<RootMove> plain;
+    root_analysis(plain, 4);
+    
+    // With two threads the lines come from both trees
+    SearchOptions parallel = options;
+    set_search_option(parallel, "Threads", "2");
+    limits.options = &parallel;
+    vector<RootMove> parallel_lines;
+    int parallel_best = getBest(board, limits, parallel_lines);
+    RootStats merged;
+    root_stats(merged);
+    bool parallel_ok = parallel_lines.size() == 4 && parallel_lines[0].move == parallel_best &&
+                       merged.visits == 5000 && parallel_lines[0].visits == merged.child_visits[parallel_best];
+    
+    double floor = MULTIPV_MIN_SHARE * root_visits / 4;
+    bool ok = parsed && lines.size() == 4 && lines[0].move == best && single_lines.size() == 1 &&
+              plain.size() == 4 && lines[3].visits + 1 >= floor && parallel_ok;
+    if (ok) {
+        cout << "  PASS: 4th move " << lines[3].visits << " visits (floor " << (int)floor
+             << "), " << plain[3].visits << " without MultiPV" << endl;
+        return true;
+    }
+    cout << "  FAIL: parsed=" << parsed << ", lines=" << lines.size() << ", parallel=" << parallel_ok;
+    if (lines.size() == 4) cout << ", 4th move visits=" << lines[3].visits << " floor=" << floor;
+    cout << endl;
+    return false;
+}
+
+// Test: the NODES option sizes the pool of the searching thread
+bool test_node_budget() {
+    cout << "\nTest Node Budget: runtime pool size..." << endl;
+    
+    Board board;
+    board.init();
+    board.set(112); board.set(113);
+    board.set(126);
+    
+    SearchOptions small;
+    bool parsed = set_search_option(small, "NODES", "10000") &&
+                  !set_search_option(small, "NODES", "100") &&
+                  !set_search_option(small, "NODES", "1000000000");
+    SearchLimits limits;
+    limits.iters = 30000;  // More iterations than nodes
+    limits.options = &small;
+    int best = getBest(board, limits);
+    int small_capacity = node_capacity;
+    int small_peak = search_stats.peak_nodes;
+    
+    // Statistics read on another thread (UCI "stats") keep the pool size
+    SearchStats copied = search_stats;
+    string json;
+    thread([&]() { json = search_stats_json(copied); }).join();
+    bool json_ok = json.find("\"max_nodes\":10000,") != string::npos;
+    
+    // Back to the default size: the pool is reallocated
+    limits.iters = 2000;
+    limits.options = nullptr;
+    limits.reuse_tree = true;
+    getBest(board, limits);
+    
+    bool ok = parsed && small_capacity == 10000 && small_peak <= 10000 && best >= 0 && json_ok &&
+              !board.b[0].get(best) && !board.b[1].get(best) && node_capacity == MAX_NODES &&
+              nodes[tree_root].visits == 2000;
+    if (ok) {
+        cout << "  PASS: 30000 iterations in a 10000-node pool, then back to " << node_capacity << endl;
+        return true;
+    }
+    cout << "  FAIL: parsed=" << parsed << ", capacity=" << small_capacity << ", peak=" << small_peak
+         << ", best=" << best << ", default capacity=" << node_capacity << ", stats json=" << json_ok << endl;
+    return false;
+}
+
+// Test: game records survive an encode/decode round trip
+bool test_game_record() {
+    cout << "\nTest Game Record: binary round trip..." << endl;
+    
+    GameRecord rec;
+    rec.game_id = 70000;
+    rec.result = 1;
+    rec.opening_plies = 2;
+    rec.moves = {{112, 0.5, 0, 0}, {113, 0.5, 0, 0}, {224, 0.25, 123456, 4321}};
+    
+    vector<uint8_t> bytes;
+    encode_record_header(bytes);
+    encode_game_record(rec, bytes);
+    encode_game_record(rec, bytes);
+    
+    const uint8_t* p = bytes.data();
+    const uint8_t* end = p + bytes.size();
+    GameRecord a, b;
+    bool ok = decode_record_header(p, end) && decode_game_record(p, end, a) &&
+              decode_game_record(p, end, b) && p == end;
+    ok = ok && a.game_id == 70000 && a.result == 1 && a.opening_plies == 2 && a.moves.size() == 3 &&
+         a.moves[2].move == 224 && fabs(a.moves[2].winrate - 0.25) < 1e-4 &&
+         a.moves[2].root_visits == 123456 && a.moves[2].best_visits == 4321;
+    
+    // A truncated record is rejected
+    p = bytes.data() + RECORD_HEADER_BYTES;
+    bool truncated = !decode_game_record(p, p + 20, b);
+    
+    if (ok && truncated && bytes.size() == (size_t)RECORD_HEADER_BYTES + 2 * (8 + 3 * 11)) {
+        cout << "  PASS: " << bytes.size() << " bytes for two 3-move games" << endl;
+        return true;
+    }
+    cout << "  FAIL: decoded=" << ok << ", truncated rejected=" << truncated
+         << ", size=" << bytes.size() << endl;
+    return false;
+}
+
+// Test: selfplay from the empty board (--opening 0) searches every move
+bool test_selfplay_opening() {
+    cout << "\nTest Selfplay: games without a random opening..." << endl;
+    
+    string path = "/tmp/gomoku_selfplay_" + to_string(getpid()) + ".bin";
+    string cmd = "./selfplay --games 2 --threads 1 --iters 50 --opening 0 --out " + path + " 2>/dev/null";
+    bool ran = system(cmd.c_str()) == 0;
+    vector<GameRecord> games;
+    bool read = ran && read_record_file(path.c_str(), games);
+    remove(path.c_str());
+    bool rejected = system("./selfplay --games 1 --iters 50 --opening 300 --out /dev/null 2>/dev/null") != 0;
+    
+    bool played = games.size() == 2;
+    for (const GameRecord& rec : games) {
+        played = played && rec.opening_plies == 0 && rec.moves.size() >= 9 && rec.moves[0].move == 112;
+    }
+    if (read && played && rejected) {
+        cout << "  PASS: 2 searched games from the empty board, --opening 300 rejected" << endl;
+        return true;
+    }
+    cout << "  FAIL: ran=" << ran << ", read=" << read << ", games=" << games.size()
+         << ", played=" << played << ", rejected=" << rejected << endl;
+    return false;
+}
+
+// Test: match games from the empty board (--opening 0) are played, not
+// scored as draws
+bool test_match_opening() {
+    cout << "\nTest Match: games without a random opening..." << endl;
+    
+    FILE* p = popen("./match --engine1 name=a,iters=50 --engine2 name=b,iters=50 --games 2 --threads 1 "
+                    "--opening 0 2>&1", "r");
+    string out;
+    char line[256];
+    while (p && fgets(line, sizeof(line), p)) out += line;
+    bool ran = p && pclose(p) == 0;
+    
+    bool played = out.find("a vs b: ") != string::npos && out.find(" =0 (2 games)") != string::npos &&
+                  out.find("a: 0 nps") == string::npos;
+    if (ran && played) {
+        cout << "  PASS: both games decided" << endl;
+        return true;
+    }
+    cout << "  FAIL: ran=" << ran << ", output:\n" << out << endl;
+    return false;
+}
+
+// Test: bench is reproducible - same signature on every run
+bool test_bench_deterministic() {
+    cout << "\nTest Bench: deterministic signature..." << endl;
+    
+    auto quiet = [](const string&) {};
+    uint64_t first = run_bench(500, quiet);
+    uint64_t second = run_bench(500, quiet);
+    
+    if (first == second) {
+        cout << "  PASS: signature " << hex << first << dec << " on both runs" << endl;
+        return true;
+    }
+    cout << "  FAIL: signatures differ: " << hex << first << " vs " << second << dec << endl;
+    return false;
+}
+
+// Test: analyze parses both input formats and keeps input order
+bool test_analyze() {
+    cout << "\nTest Analyze: batch positions in input order..." << endl;
+    
+    Board board;
+    string error;
+    string cells(225, '.');
+    cells[112] = 'X'; cells[113] = 'O'; cells[127] = 'x';
+    bool moves_ok = parse_position("112, 113 127", 12, board, error) && board.cnt == 3;
+    bool board_ok = parse_position(cells.c_str(), cells.size(), board, error) &&
+                    board.cnt == 3 && board.b[0].get(127) && board.b[1].get(113);
+    bool bad_rejected = !parse_position("112 112", 7, board, error) &&
+                        !parse_position("1000", 4, board, error) &&
+                        !parse_position("0 15 1 16 2 17 3 18 4 19", 24, board, error);
+    
+    // A board line at the very end of a mapping: nothing past its 225 bytes is read
+    long page = sysconf(_SC_PAGESIZE);
+    char* map = (char*)mmap(nullptr, 2 * page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    mprotect(map + page, page, PROT_NONE);
+    memcpy(map + page - 225, cells.data(), 225);
+    board_ok = board_ok && parse_position(map + page - 225, 225, board, error) && board.cnt == 3;
+    munmap(map, 2 * page);
+    
+    char path[] = "/tmp/gomoku_analyze_XXXXXX";
+    int fd = mkstemp(path);
+    FILE* in = fdopen(fd, "w");
+    fprintf(in, "# comment\n112 113 126\n\n112 112\n%s\n", cells.c_str());
+    for (int i = 0; i < 8; i++) fprintf(in, "112 113 %d\n", 126 + i);
+    fclose(in);
+    
+    AnalyzeConfig cfg;
+    cfg.iters = 200;
+    string outputs[2];
+    long long count = 0;
+    for (int t = 0; t < 2; t++) {
+        cfg.threads = t + 1;
+        FILE* out = tmpfile();
+        count = run_analyze(path, cfg, out);
+        rewind(out);
+        char line[256];
+        while (fgets(line, sizeof(line), out)) {
+            string s = line;
+            size_t time = s.find(",\"time_ms\"");  // Timing differs between runs
+            outputs[t] += time == string::npos ? s : s.substr(0, time) + "\n";
+        }
+        fclose(out);
+    }
+    
+    // With Threads > 1 the numbers cover all trees, like the chosen move
+    search_options.threads = 2;
+    cfg.threads = 1;
+    FILE* out = tmpfile();
+    run_analyze(path, cfg, out);
+    rewind(out);
+    char first[256] = "";
+    if (!fgets(first, sizeof(first), out)) first[0] = '\0';
+    fclose(out);
+    search_options.threads = 1;
+    bool merged = strstr(first, "\"root_visits\":200,") != nullptr;
+    remove(path);
+    
+    bool ordered = outputs[0].find("{\"line\":2,") == 0 &&
+                   outputs[0].find("{\"line\":4,\"error\"") < outputs[0].find("{\"line\":5,") &&
+                   outputs[0].find("{\"line\":13,") != string::npos;
+    if (moves_ok && board_ok && bad_rejected && count == 11 && ordered && outputs[0] == outputs[1] && merged) {
+        cout << "  PASS: 11 positions, same ordered output with 1 and 2 threads" << endl;
+        return true;
+    }
+    cout << "  FAIL: moves=" << moves_ok << ", board=" << board_ok << ", rejected=" << bad_rejected
+         << ", count=" << count << ", ordered=" << ordered
+         << ", threads agree=" << (outputs[0] == outputs[1]) << ", merged=" << merged << endl;
+    return false;
+}
+
+// Read 'count' reply lines from a server connection (5 s timeout)
+static vector<string> read_replies(int fd, int count) {
+    vector<string> lines;
+    string pending;
+    char buf[1024];
+    while ((int)lines.size() < count) {
+        size_t nl = pending.find('\n');
+        if (nl != string::npos) {
+            lines.push_back(pending.substr(0, nl));
+            pending.erase(0, nl + 1);
+            continue;
+        }
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) break;
+        pending.append(buf, n);
+    }
+    return lines;
+}
+
+static bool has_line(const vector<string>& lines, const string& prefix) {
+    for (const string& l : lines) {
+        if (l.compare(0, prefix.size(), prefix) == 0) return true;
+    }
+    return false;
+}
+
+// Test: server sessions, back-pressure and deadlines over a Unix socket
+bool test_server() {
+    cout << "\nTest Server: sessions over a Unix socket..." << endl;
+    
+    ServerConfig cfg;
+    cfg.socket_path = "/tmp/gomoku_test_" + to_string(getpid()) + ".sock";
+    cfg.workers = 1;
+    cfg.queue_size = 1;
+    cfg.send_timeout_ms = 200;
+    atomic<bool> stop(false);
+    thread server([&]() { run_server(cfg, &stop); });
+    
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, cfg.socket_path.c_str());
+    auto connect_client = [&]() {
+        int c = -1;
+        for (int attempt = 0; attempt < 100 && c < 0; attempt++) {
+            c = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (connect(c, (sockaddr*)&addr, sizeof(addr)) != 0) {
+                close(c);
+                c = -1;
+                this_thread::sleep_for(chrono::milliseconds(10));
+            }
+        }
+        timeval timeout{5, 0};
+        setsockopt(c, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        return c;
+    };
+    int fd = connect_client();
+    auto request = [&](const string& text, int replies) {
+        send(fd, text.data(), text.size(), 0);
+        return read_replies(fd, replies);
+    };
+    
+    // One search runs, one waits, the third is turned away
+    vector<string> setup = request("new a\nupdate a 112\nupdate a 112\nnew b\nupdate b 112\n"
+                                   "new c\nupdate c 112\n", 7);
+    vector<string> queued = request("go a iters 5000\ngo b iters 200\ngo c iters 200\ngo a\n", 2);
+    vector<string> results = read_replies(fd, 2);
+    // A search that waits past its deadline is dropped
+    vector<string> expired = request("go a iters 5000\ngo c iters 200 deadline 1\n", 2);
+    vector<string> closing = request("close a\nupdate a 113\n", 2);
+    
+    // A client that leaves during its search: once it is reaped, the next
+    // client (likely given the same fd number) must not get its reply
+    int gone = connect_client();
+    string go = "new g\nupdate g 112\ngo g movetime 1000\n";
+    send(gone, go.data(), go.size(), 0);
+    bool gone_ok = read_replies(gone, 2).size() == 2;
+    close(gone);
+    this_thread::sleep_for(chrono::milliseconds(400));  // Past the accept loop's reap
+    int next = connect_client();
+    timeval short_timeout{2, 0};
+    setsockopt(next, SOL_SOCKET, SO_RCVTIMEO, &short_timeout, sizeof(short_timeout));
+    string hello = "new h\nupdate g 113\n";  // g left with its client
+    send(next, hello.data(), hello.size(), 0);
+    vector<string> leaked = read_replies(next, 3);
+    bool isolated = gone_ok && leaked.size() == 2 && leaked[0] == "ok h" &&
+                    leaked[1] == "error g unknown session";
+    
+    // A client that stops reading while its search runs is cut off, and
+    // the worker goes on to the next search
+    int stalled = connect_client();
+    timeval send_timeout{2, 0};
+    setsockopt(stalled, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout));
+    string flood = "new s\nupdate s 112\ngo s movetime 300\n";
+    for (int i = 0; i < 1000; i++) flood += "status\n";
+    for (int i = 0; i < 100; i++) {
+        if (send(stalled, flood.data(), flood.size(), MSG_NOSIGNAL) <= 0) break;
+    }
+    string after = "update h 112\ngo h iters 100\n";
+    send(next, after.data(), after.size(), 0);
+    vector<string> served = read_replies(next, 2);
+    close(stalled);
+    close(next);
+    bool unblocked = served.size() == 2 && served[1].compare(0, 11, "bestmove h ") == 0;
+    
+    close(fd);
+    stop = true;
+    server.join();
+    
+    bool ok = setup.size() == 7 && setup[2] == "error a invalid move" &&
+              queued.size() == 2 && queued[0] == "busy c" && queued[1] == "error a search in progress" &&
+              has_line(results, "bestmove a ") && has_line(results, "bestmove b ") &&
+              has_line(expired, "error c deadline") && has_line(expired, "bestmove a ") &&
+              closing.size() == 2 && closing[0] == "ok a" && closing[1] == "error a unknown session" &&
+              isolated && unblocked && access(cfg.socket_path.c_str(), F_OK) != 0;
+    if (ok) {
+        cout << "  PASS: sessions, busy reply, deadline drop, disconnects and stalled clients behave" << endl;
+        return true;
+    }
+    cout << "  FAIL: replies:";
+    for (auto* v : {&setup, &queued, &results, &expired, &closing, &leaked, &served}) {
+        for (const string& l : *v) cout << " [" << l << "]";
+    }
+    cout << endl;
+    return false;
+}
+
 // Test 3: Very important test (complex position)
 bool test_search_complex() {
     cout << "\nTest Search 3: Two live-2s position..." << endl;
@@ -1115,6 +2069,88 @@ bool test_gap_blocked_end() {
     }
 }
 
+// ============================================================================
+// Test: D4 symmetry tables and symmetric move pruning
+// ============================================================================
+bool test_symmetry() {
+    cout << "\nTest Symmetry: D4 tables and canonical moves..." << endl;
+    bool all_passed = true;
+
+    // Every symmetry must be a permutation of the 225 cells
+    for (int k = 0; k < NUM_SYMMETRIES; k++) {
+        bool seen[225] = {false};
+        for (int i = 0; i < 225; i++) seen[sym_table[k][i]] = true;
+        for (int i = 0; i < 225; i++) {
+            if (!seen[i]) {
+                cout << "  FAIL: sym_table[" << k << "] is not a permutation" << endl;
+                all_passed = false;
+                break;
+            }
+        }
+    }
+
+    // Center stone: all 8 symmetries hold, 24 neighbours collapse to 5 orbits
+    Board board;
+    board.init();
+    board.set(112);
+    int sym = board.symmetries();
+    int canon = canonical_moves(board, board.nxt).popcount();
+    if (sym != 0xFF || canon != 5) {
+        cout << "  FAIL: Center stone symmetries=" << sym << ", canonical moves=" << canon << " (expected 255, 5)" << endl;
+        all_passed = false;
+    }
+
+    // Black (7,7) + White (7,8): only the top-bottom mirror survives
+    board.set(113);
+    sym = board.symmetries();
+    if (sym != ((1 << 0) | (1 << 5))) {
+        cout << "  FAIL: Horizontal pair symmetries=" << sym << " (expected identity + top-bottom)" << endl;
+        all_passed = false;
+    }
+
+    // Asymmetric position: nothing pruned
+    board.set(128);
+    if (board.symmetries() != 1 || canonical_moves(board, board.nxt).popcount() != board.nxt.popcount()) {
+        cout << "  FAIL: Asymmetric position should keep all moves" << endl;
+        all_passed = false;
+    }
+
+    if (all_passed) {
+        cout << "  PASS: Symmetry tables and canonical move pruning" << endl;
+    }
+    return all_passed;
+}
+
+// ============================================================================
+// Test: Move ordering for progressive widening
+// ============================================================================
+bool test_move_ordering() {
+    cout << "\nTest Move Ordering: widening score..." << endl;
+    bool all_passed = true;
+    
+    // Black: (7,6), (7,7), (7,8); White: (6,7), (8,8), (0,0)
+    Board board;
+    board.init();
+    board.set(111); board.set(97);
+    board.set(112); board.set(128);
+    board.set(113); board.set(0);   // White (0,0), Black to move with a live three
+    
+    int extend = move_order_score(board, 114, board.last_move, 113);   // .XXX. -> .XXXX
+    int near = move_order_score(board, 83, board.last_move, 113);      // (5,8): loose contact
+    int corner = move_order_score(board, 224, board.last_move, 113);   // (14,14): nothing
+    
+    cout << "  Scores: extend=" << extend << ", near=" << near << ", corner=" << corner << endl;
+    if (!(extend > near && near > corner)) {
+        cout << "  FAIL: Expected extend > near > corner" << endl;
+        all_passed = false;
+    }
+    
+    if (all_passed) {
+        cout << "  PASS: Pattern moves ordered before distant moves" << endl;
+    }
+    return all_passed;
+}
+
 // ============================================================================
 // Main
 // ============================================================================
@@ -1133,6 +2169,8 @@ int main() {
     all_passed &= test_nxt_moves();
     all_passed &= test_performance();
     all_passed &= test_popbit_performance();
+    all_passed &= test_symmetry();
+    all_passed &= test_move_ordering();
 
     // Phase 2 tests
     all_passed &= test_threat_tables();
@@ -1141,6 +2179,26 @@ int main() {
     all_passed &= test_search_live3_defend();
     all_passed &= test_search_performance();
     all_passed &= test_search_threat_priority();
+    all_passed &= test_search_rave();
+    all_passed &= test_tree_reuse();
+    all_passed &= test_game_state();
+    all_passed &= test_search_seed();
+    all_passed &= test_rollout_batch();
+    all_passed &= test_pattern_eval();
+    all_passed &= test_concurrent_search();
+    all_passed &= test_parallel_search();
+    all_passed &= test_search_options();
+    all_passed &= test_search_stop();
+    all_passed &= test_node_budget();
+    all_passed &= test_search_resume();
+    all_passed &= test_root_analysis();
+    all_passed &= test_multipv();
+    all_passed &= test_game_record();
+    all_passed &= test_selfplay_opening();
+    all_passed &= test_match_opening();
+    all_passed &= test_bench_deterministic();
+    all_passed &= test_analyze();
+    all_passed &= test_server();
     
     // Gap-blocked pattern tests (verify opponent pieces block threats correctly)
     all_passed &= test_gap_blocked_live3();
@@ -5,87 +5,343 @@
 #include "uci.h"
 #include "board.h"
 #include "search.h"
+#include "profile.h"
+#include "bench.h"
+#include "game.h"
 #include <iostream>
+#include <cstdio>
+#include <cstdlib>
 #include <sstream>
 #include <string>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 using namespace std;
 
-// Global board state
-static Board g_board;
+constexpr int INFO_INTERVAL_MS = 1000;  // Period of "info" lines during a search
+
+// Global game state (g_game.board is the current position)
+static GameState g_game;
+
+// Search thread: a single long-lived worker runs one go/ponder search at a
+// time while the main thread keeps reading commands. The search tree belongs
+// to the thread that builds it, so reusing one worker keeps the tree (and
+// pondering's subtree) from one search to the next.
+static thread g_search_thread;
+static mutex g_job_mutex;
+static condition_variable g_job_cv;
+static bool g_job_ready = false;        // A job is waiting for the worker
+static bool g_quit = false;             // Worker should exit
+static Board g_job_board;
+static SearchLimits g_job_limits;
+static bool g_job_ponder = false;
+static atomic<bool> g_stop(false);      // Set to end the running search
+static atomic<bool> g_running(false);   // Job queued or search in progress
+static bool g_pondering = false;        // Running search is a ponder search
+static bool g_unbounded = false;        // Running search only ends when stopped
+static int g_ponder_best = -1;          // Result of the last ponder search
+static SearchStats g_last_stats;        // Statistics of the last finished search
+static int g_analysis = 0;              // Root moves listed after each info line (ANALYSIS option)
+
+// stdout is shared with the search thread
+static mutex g_out_mutex;
+
+static void send(const string& msg) {
+    lock_guard<mutex> lock(g_out_mutex);
+    cout << msg << endl;
+}
+
+static void send_info(const SearchInfo& info) {
+    ostringstream oss;
+    int nps = info.elapsed_ms > 0 ? (int)((long long)info.iters * 1000 / info.elapsed_ms) : 0;
+    char wr[16];
+    snprintf(wr, sizeof(wr), "%.4f", info.winrate);
+    oss << "info iters " << info.iters << " nps " << nps << " time " << info.elapsed_ms
+        << " nodes " << info.nodes << " depth " << info.max_depth << " winrate " << wr;
+    if (!info.pv.empty()) {
+        oss << " pv";
+        for (int m : info.pv) oss << " " << m;
+    }
+    for (const RootMove& rm : info.moves) oss << "\ninfo " << root_move_line(rm);
+    send(oss.str());
+}
+
+// Worker loop: normal searches print "bestmove" when done; ponder searches
+// stay silent and leave their result in g_ponder_best
+static void search_worker() {
+    unique_lock<mutex> lock(g_job_mutex);
+    while (true) {
+        g_job_cv.wait(lock, []() { return g_job_ready || g_quit; });
+        if (g_quit) return;
+        g_job_ready = false;
+        Board board = g_job_board;
+        SearchLimits limits = g_job_limits;
+        bool ponder = g_job_ponder;
+        lock.unlock();
+        
+        int best = getBest(board, limits);
+        {
+            lock_guard<mutex> out(g_out_mutex);
+            g_last_stats = search_stats;
+        }
+        if (ponder) {
+            g_ponder_best = best;
+        } else {
+            send("bestmove " + to_string(best));
+        }
+        
+        lock.lock();
+        g_running = false;
+        g_job_cv.notify_all();
+    }
+}
+
+// Wait for the running search (stopping it first); the tree is kept
+static void stop_search() {
+    unique_lock<mutex> lock(g_job_mutex);
+    if (!g_running) return;
+    g_stop = true;
+    g_job_cv.wait(lock, []() { return !g_running; });
+    g_pondering = false;
+    g_unbounded = false;
+}
+
+// Let a bounded search finish on its own (end of input)
+static void finish_search() {
+    if (!g_unbounded) {
+        unique_lock<mutex> lock(g_job_mutex);
+        g_job_cv.wait(lock, []() { return !g_running; });
+    }
+    stop_search();
+}
+
+// Stop the worker thread (after stop_search/finish_search)
+static void shutdown_worker() {
+    {
+        lock_guard<mutex> lock(g_job_mutex);
+        g_quit = true;
+    }
+    g_job_cv.notify_all();
+    if (g_search_thread.joinable()) g_search_thread.join();
+}
+
+// Hand a search of the current position to the worker
+static void start_search(SearchLimits limits, bool ponder) {
+    stop_search();
+    g_stop = false;
+    g_pondering = ponder;
+    g_unbounded = limits.iters <= 0 && limits.movetime_ms <= 0;
+
+    limits.stop = &g_stop;
+    limits.reuse_tree = true;
+    limits.info_interval_ms = INFO_INTERVAL_MS;
+    limits.on_info = send_info;
+    // MultiPV lists its top moves unless ANALYSIS asks for another count
+    limits.analysis = g_analysis != 0 ? g_analysis : search_options.multipv > 1 ? search_options.multipv : 0;
+
+    if (!g_search_thread.joinable()) g_search_thread = thread(search_worker);
+    {
+        lock_guard<mutex> lock(g_job_mutex);
+        g_job_board = g_game.board;
+        g_job_limits = limits;
+        g_job_ponder = ponder;
+        g_job_ready = true;
+        g_running = true;
+    }
+    g_job_cv.notify_all();
+}
 
 // Helper: Display board
 static void display_board() {
-    cout << "   ";
-    for (int c = 0; c < 15; c++) cout << (c < 10 ? " " : "") << c;
-    cout << endl;
+    ostringstream out;
+    out << "   ";
+    for (int c = 0; c < 15; c++) out << (c < 10 ? " " : "") << c;
+    out << endl;
     for (int r = 0; r < 15; r++) {
-        cout << (r < 10 ? " " : "") << r << " ";
+        out << (r < 10 ? " " : "") << r << " ";
         for (int c = 0; c < 15; c++) {
             int idx = r * 15 + c;
-            if (g_board.b[0].get(idx)) cout << " X";
-            else if (g_board.b[1].get(idx)) cout << " O";
-            else cout << " .";
+            if (g_game.board.b[0].get(idx)) out << " X";
+            else if (g_game.board.b[1].get(idx)) out << " O";
+            else out << " .";
         }
-        cout << endl;
+        out << endl;
     }
-    cout << "Move count: " << g_board.cnt << ", ";
-    cout << (g_board.side() == 0 ? "Black" : "White") << " to move" << endl;
-    if (g_board.res == 1) cout << "Result: Black wins" << endl;
-    else if (g_board.res == 0) cout << "Result: White wins" << endl;
+    out << "Move count: " << g_game.board.cnt << ", ";
+    out << (g_game.board.side() == 0 ? "Black" : "White") << " to move";
+    if (g_game.board.res == 1) out << endl << "Result: Black wins";
+    else if (g_game.board.res == 0) out << endl << "Result: White wins";
+    send(out.str());
 }
 
 void uci_loop() {
     string line;
-    
+
     while (getline(cin, line)) {
         istringstream iss(line);
         string cmd;
         iss >> cmd;
-        
+
         if (cmd == "uci") {
-            cout << "id name DeepReaL Gomoku v0" << endl;
-            cout << "id author DeepReaL" << endl;
-            cout << "uciok" << endl;
+            send("id name DeepReaL Gomoku v0");
+            send("id author DeepReaL");
+            send("uciok");
+        }
+        else if (cmd == "isready") {
+            send("readyok");
         }
         else if (cmd == "init") {
+            stop_search();
             init_precompute();
             init_threat_tables();
-            g_board.init();
-            cout << "ready" << endl;
+            g_game.reset();
+            send("ready");
         }
         else if (cmd == "update") {
             int index;
             if (iss >> index) {
-                if (index >= 0 && index < 225 && g_board.res == -1) {
-                    g_board.set(index);
-                    cout << "ok" << endl;
+                // The opponent's move arrived: stop pondering, keep the subtree
+                stop_search();
+                if (g_game.play(index)) {
+                    send("ok");
                 } else {
-                    cout << "error: invalid move" << endl;
+                    send("error: invalid move");
                 }
             } else {
-                cout << "error: missing index" << endl;
+                send("error: missing index");
             }
         }
+        else if (cmd == "position") {
+            // position startpos [moves i j ...]
+            // position board <225 cells> [side <s>] [moves i j ...]
+            // The whole position is applied at once; the search tree is
+            // kept if the new position continues the current one
+            stop_search();
+            string err = g_game.set_position(iss);
+            send(err.empty() ? "ok" : err);
+        }
+        else if (cmd == "takeback") {
+            // takeback [n]: undo the last n moves (default 1); the tree
+            // steps back to the earlier position if it is still in the pool
+            stop_search();
+            string err = g_game.takeback(iss);
+            send(err.empty() ? "ok" : err);
+        }
         else if (cmd == "go") {
-            int iters = 10000;  // default
-            iss >> iters;
-            
-            if (g_board.res != -1) {
-                cout << "error: game already ended" << endl;
+            // go [<iters>] [iters <n>] [movetime <ms>] [infinite] [ponder]
+            SearchLimits limits;
+            bool ponder = false;
+            bool has_iters = false, has_time = false;
+            string arg;
+            while (iss >> arg) {
+                if (arg == "ponder") {
+                    ponder = true;
+                } else if (arg == "infinite") {
+                    limits.iters = 0;
+                    has_iters = true;
+                } else if (arg == "movetime") {
+                    iss >> limits.movetime_ms;
+                    has_time = true;
+                } else if (arg == "iters") {
+                    iss >> limits.iters;
+                    has_iters = true;
+                } else {
+                    limits.iters = atoi(arg.c_str());
+                    has_iters = true;
+                }
+            }
+            if (has_time && !has_iters) limits.iters = 0;
+            if (ponder) {
+                // Search until ponderhit/stop/update
+                limits.iters = 0;
+                limits.movetime_ms = 0;
+            }
+
+            if (g_game.board.res != -1) {
+                send("error: game already ended");
+            } else if (g_running && !g_pondering) {
+                send("error: search in progress");
+            } else {
+                start_search(limits, ponder);
+            }
+        }
+        else if (cmd == "ponderhit") {
+            // The pondered position is the real one: finish with a normal search
+            SearchLimits limits;
+            iss >> limits.iters;
+            if (g_pondering) {
+                start_search(limits, false);
             } else {
-                int best = getBest(g_board, iters);
-                cout << "bestmove " << best << endl;
+                send("error: not pondering");
             }
         }
+        else if (cmd == "stop") {
+            bool was_pondering = g_pondering;
+            stop_search();
+            if (was_pondering) send("bestmove " + to_string(g_ponder_best));
+        }
+        else if (cmd == "setoption") {
+            // setoption name <name> value <value>
+            string tok, name, value;
+            iss >> tok >> name >> tok >> value;
+            stop_search();
+            if (name == "ANALYSIS") {
+                // Root moves (by visits) listed after each info line; -1 = all
+                int n = atoi(value.c_str());
+                if (n >= -1 && n <= 225 && !value.empty()) {
+                    g_analysis = n;
+                    send("ok");
+                } else {
+                    send("error: invalid option");
+                }
+            } else if (set_search_option(name, value)) {
+                send("ok");
+            } else {
+                send("error: invalid option");
+            }
+        }
+        else if (cmd == "stats") {
+            // Counters of the last finished search as JSON
+            SearchStats stats;
+            {
+                lock_guard<mutex> lock(g_out_mutex);
+                stats = g_last_stats;
+            }
+            send("stats " + search_stats_json(stats));
+        }
+        else if (cmd == "profile") {
+            // profile [reset]: hot-path counters (profile builds only)
+            string arg;
+            iss >> arg;
+            if (arg == "reset") {
+                profile_reset();
+                send("ok");
+            } else {
+                send(profile_report());
+            }
+        }
+        else if (cmd == "bench") {
+            // bench [iters]: fixed positions, fixed seed (replaces the tree)
+            int iters = BENCH_ITERS;
+            iss >> iters;
+            stop_search();
+            run_bench(iters, send);
+        }
         else if (cmd == "d") {
             display_board();
         }
         else if (cmd == "quit") {
-            break;
+            stop_search();
+            shutdown_worker();
+            return;
         }
         else if (!cmd.empty()) {
-            cout << "unknown command: " << cmd << endl;
+            send("unknown command: " + cmd);
         }
     }
+
+    finish_search();
+    shutdown_worker();
 }
@@ -1,5 +1,9 @@
 #!/usr/bin/env python3
-"""Simple HTTP server with no-cache headers for development."""
+"""Simple HTTP server with no-cache headers for development.
+
+Also sends the cross-origin isolation headers (COOP/COEP) that browsers
+require before they expose SharedArrayBuffer, so the multithreaded engine
+module can be used."""
 import http.server
 import functools
 import os
@@ -9,10 +13,12 @@ class NoCacheHTTPRequestHandler(http.server.SimpleHTTPRequestHandler):
         self.send_header('Cache-Control', 'no-store, no-cache, must-revalidate, max-age=0')
         self.send_header('Pragma', 'no-cache')
         self.send_header('Expires', '0')
+        self.send_header('Cross-Origin-Opener-Policy', 'same-origin')
+        self.send_header('Cross-Origin-Embedder-Policy', 'require-corp')
         super().end_headers()
 
 if __name__ == '__main__':
     os.chdir(os.path.join(os.path.dirname(os.path.abspath(__file__)), 'web'))
     server = http.server.HTTPServer(('', 8080), NoCacheHTTPRequestHandler)
-    print(f'Serving at http://localhost:8080 (no-cache)')
+    print(f'Serving at http://localhost:8080 (no-cache, cross-origin isolated)')
     server.serve_forever()
@@ -29,28 +29,54 @@ fi
 # Create output directory
 mkdir -p "$OUTPUT_DIR"
 
-# Compile
-echo "Compiling..."
-emcc \
-    -std=c++17 \
-    -O2 \
-    -s WASM=1 \
-    -s MODULARIZE=1 \
-    -s EXPORT_NAME="'GomokuEngine'" \
-    -s ALLOW_MEMORY_GROWTH=1 \
-    -s INITIAL_MEMORY=536870912 \
-    -s MAXIMUM_MEMORY=1073741824 \
-    -s NO_EXIT_RUNTIME=1 \
-    -s ENVIRONMENT='worker' \
-    --bind \
-    "$WASM_SRC" \
-    "$ENGINE_SRC/board.cpp" \
-    "$ENGINE_SRC/precompute.cpp" \
-    "$ENGINE_SRC/search.cpp" \
-    -o "$OUTPUT_DIR/gomoku_engine.js"
+# Compile: build_module <output name> [extra flags...]
+build_module() {
+    local name="$1"
+    shift
+    emcc \
+        -std=c++17 \
+        -O2 \
+        -s WASM=1 \
+        -s MODULARIZE=1 \
+        -s EXPORT_NAME="'GomokuEngine'" \
+        -s ALLOW_MEMORY_GROWTH=1 \
+        -s INITIAL_MEMORY=8388608 \
+        -s MAXIMUM_MEMORY=1073741824 \
+        -s NO_EXIT_RUNTIME=1 \
+        -s ENVIRONMENT='worker' \
+        -s "EXPORTED_RUNTIME_METHODS=['HEAPU8','HEAP32']" \
+        "$@" \
+        --bind \
+        "$WASM_SRC" \
+        "$ENGINE_SRC/bench.cpp" \
+        "$ENGINE_SRC/board.cpp" \
+        "$ENGINE_SRC/game.cpp" \
+        "$ENGINE_SRC/precompute.cpp" \
+        "$ENGINE_SRC/profile.cpp" \
+        "$ENGINE_SRC/rollout_batch.cpp" \
+        "$ENGINE_SRC/search.cpp" \
+        -o "$OUTPUT_DIR/$name.js"
+}
+
+# Scalar module (fallback) and simd128 module (used where supported)
+echo "Compiling scalar module..."
+build_module gomoku_engine
+echo "Compiling SIMD module..."
+build_module gomoku_engine_simd -msimd128
+# Multithreaded module (see MTFLAGS in the top-level Makefile); its memory
+# ceiling comes after the default and overrides it; Threads is capped at
+# the pool size plus the calling thread
+echo "Compiling multithreaded module..."
+MT_POOL=7
+build_module gomoku_engine_mt -pthread -msimd128 -s PTHREAD_POOL_SIZE=$MT_POOL -DGOMOKU_THREAD_POOL=$MT_POOL \
+    -s MAXIMUM_MEMORY=2147483648
 
 echo "=== Build complete ==="
 echo "Output files:"
 echo "  $OUTPUT_DIR/gomoku_engine.js"
 echo "  $OUTPUT_DIR/gomoku_engine.wasm"
-ls -la "$OUTPUT_DIR/gomoku_engine."*
+echo "  $OUTPUT_DIR/gomoku_engine_simd.js"
+echo "  $OUTPUT_DIR/gomoku_engine_simd.wasm"
+echo "  $OUTPUT_DIR/gomoku_engine_mt.js"
+echo "  $OUTPUT_DIR/gomoku_engine_mt.wasm"
+ls -la "$OUTPUT_DIR/gomoku_engine"*
@@ -5,19 +5,54 @@
 
 #include "../DeepReaL-Gomoku-Engine-v0-main/src/board.h"
 #include "../DeepReaL-Gomoku-Engine-v0-main/src/search.h"
+#include "../DeepReaL-Gomoku-Engine-v0-main/src/profile.h"
+#include "../DeepReaL-Gomoku-Engine-v0-main/src/bench.h"
+#include "../DeepReaL-Gomoku-Engine-v0-main/src/game.h"
 #include <emscripten/emscripten.h>
 #include <emscripten/bind.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
 #include <string>
 #include <sstream>
+#include <vector>
 
-static Board g_board;
+static GameState g_game;  // g_game.board is the current position
 static bool g_initialized = false;
 
+// Time-sliced search in progress (see engine_search_start); ended by any
+// command that changes the position or runs another search
+struct SliceSearch {
+    bool active = false;
+    bool started = false;       // A slice has run (later slices resume)
+    bool done = false;          // Limits reached
+    int iters = 0;              // Total limits (0 = none)
+    int movetime_ms = 0;
+    int best = -1;              // Best move after the last slice
+};
+static SliceSearch g_slice;
+
+// Stop flag polled by every search (SearchLimits::stop), cleared when a
+// search starts. A stopped search returns its best move so far. The worker
+// can set it between slices (engine_stop); with the multithreaded module
+// the heap is a SharedArrayBuffer and the page sets it directly at
+// engine_stop_ptr, which also cuts short a search the worker is blocked in.
+static std::atomic<bool> g_stop(false);
+
+// True when the search tree's root is the current position
+static bool tree_at_position() {
+    const Board& board = g_game.board;
+    return tree_root >= 0 && tree_board.cnt == board.cnt &&
+           (tree_board.b[0] & ~board.b[0]).empty() && (tree_board.b[1] & ~board.b[1]).empty();
+}
+
 // Initialize the engine (precomputed tables + board)
 std::string engine_init() {
     init_precompute();
     init_threat_tables();
-    g_board.init();
+    g_game.reset();
+    g_slice.active = false;
     g_initialized = true;
     return "ready";
 }
@@ -26,21 +61,22 @@ std::string engine_init() {
 std::string engine_update(int index) {
     if (!g_initialized) return "error: not initialized";
     if (index < 0 || index >= 225) return "error: invalid index";
-    if (g_board.res != -1) return "error: game already ended";
+    if (g_game.board.res != -1) return "error: game already ended";
     
     // Check if position is already occupied
-    if (g_board.b[0].get(index) || g_board.b[1].get(index)) {
+    if (g_game.board.b[0].get(index) || g_game.board.b[1].get(index)) {
         return "error: position occupied";
     }
     
-    g_board.set(index);
+    g_game.play(index);
+    g_slice.active = false;
     
     // Check for terminal state after move
-    if (g_board.res == 1) return "ok win black";
-    if (g_board.res == 0) return "ok win white";
+    if (g_game.board.res == 1) return "ok win black";
+    if (g_game.board.res == 0) return "ok win white";
     
     // Check for draw (board full)
-    if (g_board.cnt >= 225) return "ok draw";
+    if (g_game.board.cnt >= 225) return "ok draw";
     
     return "ok";
 }
@@ -48,45 +84,305 @@ std::string engine_update(int index) {
 // Run MCTS and return best move
 std::string engine_go(int iters) {
     if (!g_initialized) return "error: not initialized";
-    if (g_board.res != -1) return "error: game already ended";
+    if (g_game.board.res != -1) return "error: game already ended";
     
     if (iters <= 0) iters = 10000;
     
-    int best = getBest(g_board, iters);
+    // Continue from the tree built while pondering, if it matches
+    g_slice.active = false;
+    g_stop = false;
+    SearchLimits limits;
+    limits.iters = iters;
+    limits.reuse_tree = true;
+    limits.stop = &g_stop;
+    int best = getBest(g_game.board, limits);
     return "bestmove " + std::to_string(best);
 }
 
+// Think on the opponent's time: run a slice of iterations on the current
+// position (opponent to move) and keep the tree for the next engine_go.
+// Once the tree holds this position, slices resume it: the rollout stream
+// and statistics carry on instead of restarting from the seed.
+std::string engine_ponder(int iters) {
+    if (!g_initialized) return "error: not initialized";
+    if (g_game.board.res != -1) return "error: game already ended";
+    if (g_game.board.cnt == 0) return "error: empty board";
+    
+    if (iters <= 0) iters = 2000;
+    
+    g_slice.active = false;
+    g_stop = false;
+    SearchLimits limits;
+    limits.iters = iters;
+    limits.reuse_tree = true;
+    limits.resume = tree_at_position();
+    limits.stop = &g_stop;
+    getBest(g_game.board, limits);
+    return "ponder " + std::to_string(iters);
+}
+
+// ============================================================================
+// Binary interface: state is written into static buffers in linear memory
+// that JS reads through typed-array views (Module.HEAPU8 / Module.HEAP32 at
+// the pointers below), with no strings or parsing on the UI path. Views must
+// be recreated when Module.HEAPU8.buffer changes (memory growth).
+// ============================================================================
+// Int32 state buffer layout (word offsets)
+constexpr int STATE_CNT = 0;            // Stones on the board
+constexpr int STATE_SIDE = 1;           // Side to move (0 = black, 1 = white)
+constexpr int STATE_RES = 2;            // -1 ongoing, 0 white won, 1 black won
+constexpr int STATE_LAST = 3;           // Last move (-1 = none)
+constexpr int STATE_BEST = 4;           // Most-visited root move (-1 = no search of this position)
+constexpr int STATE_ROOT_VISITS = 5;    // Root visits
+constexpr int STATE_ROOT_WINS = 6;      // Root wins for the side to move, x2 (win rate = wins / (2 * visits))
+constexpr int STATE_ITERS = 7;          // Iterations of the last search
+constexpr int STATE_TIME_MS = 8;        // Duration of the last search
+constexpr int STATE_NODES = 9;          // Nodes in the pool
+constexpr int STATE_CHILDREN = 10;      // Root children listed below
+constexpr int STATE_HEADER = 16;        // Children start here: (move, visits, wins x2 for the side to move)
+constexpr int STATE_WORDS = STATE_HEADER + 3 * 225;
+
+static uint8_t g_cells[225];            // 0 = empty, 1 = black, 2 = white
+static int32_t g_state[STATE_WORDS];
+static int32_t g_heatmap[2 * 225];      // Root visits by cell, then wins x2 for the side to move by cell
+
+// Fill g_cells, g_state and g_heatmap from the current position; root statistics come
+// from the search tree when its root is this position. Returns the number
+// of root children written.
+static int write_state() {
+    const Board& board = g_game.board;
+    for (int i = 0; i < 225; i++) {
+        g_cells[i] = board.b[0].get(i) ? 1 : board.b[1].get(i) ? 2 : 0;
+    }
+    g_state[STATE_CNT] = board.cnt;
+    g_state[STATE_SIDE] = board.side();
+    g_state[STATE_RES] = board.res;
+    g_state[STATE_LAST] = board.last_move;
+    g_state[STATE_BEST] = -1;
+    g_state[STATE_ROOT_VISITS] = g_state[STATE_ROOT_WINS] = 0;
+    g_state[STATE_ITERS] = (int32_t)search_stats.iterations;
+    g_state[STATE_TIME_MS] = (int32_t)search_stats.total_ms;
+    g_state[STATE_NODES] = node_count;
+    g_state[STATE_CHILDREN] = 0;
+    memset(g_heatmap, 0, sizeof(g_heatmap));
+    
+    if (!tree_at_position()) return 0;
+    
+    // Wins are black's (x2); report them for the side to move. With Threads > 1
+    // the statistics are summed over all search trees.
+    auto wins_for = [&](int visits, int wins) { return board.side() == 0 ? wins : 2 * visits - wins; };
+    static RootStats root;
+    root_stats(root);
+    g_state[STATE_ROOT_VISITS] = root.visits;
+    g_state[STATE_ROOT_WINS] = wins_for(root.visits, root.wins);
+    int best_visits = 0;
+    for (int i = 0; i < root.count; i++) {
+        int move = root.moves[i];
+        int32_t* entry = g_state + STATE_HEADER + 3 * i;
+        entry[0] = move;
+        entry[1] = root.child_visits[move];
+        entry[2] = wins_for(root.child_visits[move], root.child_wins[move]);
+        g_heatmap[move] = entry[1];
+        g_heatmap[225 + move] = entry[2];
+        if (entry[1] > best_visits) {
+            best_visits = entry[1];
+            g_state[STATE_BEST] = move;
+        }
+    }
+    g_state[STATE_CHILDREN] = root.count;
+    return root.count;
+}
+
+extern "C" {
+
+EMSCRIPTEN_KEEPALIVE uint8_t* engine_cells_ptr() { return g_cells; }
+EMSCRIPTEN_KEEPALIVE int32_t* engine_state_ptr() { return g_state; }
+EMSCRIPTEN_KEEPALIVE int32_t* engine_heatmap_ptr() { return g_heatmap; }
+
+// Stop flag (one byte, non-zero = stop); see g_stop
+EMSCRIPTEN_KEEPALIVE uint8_t* engine_stop_ptr() { return reinterpret_cast<uint8_t*>(&g_stop); }
+EMSCRIPTEN_KEEPALIVE void engine_stop() { g_stop = true; }
+
+// Refresh both buffers; returns the number of root children (-1 if not initialized)
+EMSCRIPTEN_KEEPALIVE int engine_write_state() {
+    if (!g_initialized) return -1;
+    return write_state();
+}
+
+// Search like engine_go and leave the result in the buffers; returns the
+// best move (-1 on error)
+EMSCRIPTEN_KEEPALIVE int engine_search(int iters) {
+    if (!g_initialized || g_game.board.res != -1) return -1;
+    g_slice.active = false;
+    g_stop = false;
+    SearchLimits limits;
+    limits.iters = iters > 0 ? iters : 10000;
+    limits.reuse_tree = true;
+    limits.stop = &g_stop;
+    int best = getBest(g_game.board, limits);
+    write_state();
+    return best;
+}
+
+}  // extern "C"
+
+// ============================================================================
+// Time-sliced search: engine_search_start sets the limits, every
+// engine_search_step runs one slice on the persistent tree (resuming the
+// previous slice) and refreshes the binary state, and engine_search_result
+// ends the search. The worker handles messages between slices.
+// ============================================================================
+
+// Start a search of the current position; no iterations run until the first step
+std::string engine_search_start(int iters, int movetime_ms) {
+    if (!g_initialized) return "error: not initialized";
+    if (g_game.board.res != -1) return "error: game already ended";
+    g_slice = SliceSearch();
+    g_slice.active = true;
+    g_stop = false;
+    g_slice.iters = std::max(0, iters);
+    g_slice.movetime_ms = std::max(0, movetime_ms);
+    if (g_slice.iters == 0 && g_slice.movetime_ms == 0) g_slice.iters = 10000;
+    return "ok";
+}
+
+// Search for up to 'ms' milliseconds (default 50). Returns
+//   info|done iters <n> time <ms> best <move> visits <n> winrate <p>
+// with the totals so far ("done" once a limit is reached or the search was
+// stopped) and the win rate for the side to move.
+std::string engine_search_step(int ms) {
+    if (!g_initialized) return "error: not initialized";
+    if (!g_slice.active) return "error: no search";
+    if (!g_slice.done) {
+        SearchLimits limits;
+        limits.reuse_tree = true;
+        limits.resume = g_slice.started;
+        limits.stop = &g_stop;
+        limits.movetime_ms = ms > 0 ? ms : 50;
+        limits.iters = 0;
+        long long done_iters = g_slice.started ? search_stats.iterations : 0;
+        double done_ms = g_slice.started ? search_stats.total_ms : 0;
+        if (g_slice.iters > 0) limits.iters = (int)(g_slice.iters - done_iters);
+        if (g_slice.movetime_ms > 0) {
+            limits.movetime_ms = std::min(limits.movetime_ms, std::max(1, (int)(g_slice.movetime_ms - done_ms)));
+        }
+        g_slice.best = getBest(g_game.board, limits);
+        g_slice.started = true;
+        
+        // A slice without iterations means the move needed no search
+        bool no_search = search_stats.iterations == done_iters;
+        g_slice.done = no_search || g_stop || (g_slice.iters > 0 && search_stats.iterations >= g_slice.iters) ||
+                       (g_slice.movetime_ms > 0 && search_stats.total_ms >= g_slice.movetime_ms);
+    }
+    write_state();
+    
+    int visits = g_state[STATE_ROOT_VISITS];
+    double winrate = visits > 0 ? g_state[STATE_ROOT_WINS] / (2.0 * visits) : 0.5;
+    char buf[160];
+    snprintf(buf, sizeof(buf), "%s iters %lld time %d best %d visits %d winrate %.4f",
+             g_slice.done ? "done" : "info", search_stats.iterations, (int)search_stats.total_ms,
+             g_slice.best, visits, winrate);
+    return buf;
+}
+
+// End the search and return "bestmove <move>"; runs one slice first if
+// none has run yet
+std::string engine_search_result() {
+    if (!g_initialized) return "error: not initialized";
+    if (!g_slice.active) return "error: no search";
+    if (!g_slice.started) engine_search_step(0);
+    g_slice.active = false;
+    return "bestmove " + std::to_string(g_slice.best);
+}
+
+// Root analysis of the current position, one line per root move ordered by
+// visits: "info move <m> visits <n> winrate <p> pv <moves...>". At most
+// max_moves lines (0 = all); empty if the tree holds no search of this position.
+std::string engine_analysis(int max_moves) {
+    if (!g_initialized) return "error: not initialized";
+    if (!tree_at_position()) return "";
+    std::vector<RootMove> moves;
+    root_analysis(moves, max_moves);
+    std::string out;
+    for (const RootMove& rm : moves) {
+        if (!out.empty()) out += "\n";
+        out += "info " + root_move_line(rm);
+    }
+    return out;
+}
+
 // Get board state as a string
 std::string engine_get_state() {
     if (!g_initialized) return "error: not initialized";
     
     std::ostringstream oss;
     oss << "state ";
-    oss << "cnt=" << g_board.cnt << " ";
-    oss << "side=" << g_board.side() << " ";
-    oss << "res=" << g_board.res << " ";
-    oss << "last=" << g_board.last_move << " ";
+    oss << "cnt=" << g_game.board.cnt << " ";
+    oss << "side=" << g_game.board.side() << " ";
+    oss << "res=" << g_game.board.res << " ";
+    oss << "last=" << g_game.board.last_move << " ";
     
     // Board cells: 0=empty, 1=black, 2=white
     oss << "board=";
     for (int i = 0; i < 225; i++) {
-        if (g_board.b[0].get(i)) oss << "1";
-        else if (g_board.b[1].get(i)) oss << "2";
+        if (g_game.board.b[0].get(i)) oss << "1";
+        else if (g_game.board.b[1].get(i)) oss << "2";
         else oss << "0";
     }
     
     return oss.str();
 }
 
+// Statistics of the last search as a JSON object
+std::string engine_get_stats() {
+    if (!g_initialized) return "error: not initialized";
+    return search_stats_json(search_stats);
+}
+
+// Run the deterministic benchmark; one line per position plus a summary
+// (discards the search tree, the game board is untouched)
+std::string engine_bench(int iters) {
+    if (!g_initialized) return "error: not initialized";
+    g_slice.active = false;
+    std::string result;
+    run_bench(iters, [&result](const std::string& line) {
+        if (!result.empty()) result += "\n";
+        result += line;
+    });
+    return result;
+}
+
 // Reset the board
 std::string engine_reset() {
     if (!g_initialized) {
         return engine_init();
     }
-    g_board.init();
+    g_game.reset();
+    g_slice.active = false;
     return "ready";
 }
 
+// Set the whole position in one call:
+//   startpos [moves i j ...] | board <225 cells> [side <b|w>] [moves i j ...]
+// The next engine_go keeps the tree if the position continues the last one
+std::string engine_position(const std::string& args) {
+    if (!g_initialized) return "error: not initialized";
+    std::istringstream iss(args);
+    std::string err = g_game.set_position(iss);
+    g_slice.active = false;
+    return err.empty() ? "ok" : err;
+}
+
+// Undo the last n moves; the tree steps back with them while its nodes
+// are still in the pool
+std::string engine_takeback(int n) {
+    if (!g_initialized) return "error: not initialized";
+    if (n < 1) return "error: invalid takeback count";
+    if (!g_game.takeback(n)) return "error: cannot take back " + std::to_string(n) + " moves";
+    g_slice.active = false;
+    return "ok";
+}
+
 // Process a UCI-like command string
 std::string engine_command(const std::string& cmd) {
     std::istringstream iss(cmd);
@@ -103,12 +399,46 @@ std::string engine_command(const std::string& cmd) {
             return engine_update(index);
         }
         return "error: missing index";
+    } else if (token == "position") {
+        std::string args;
+        std::getline(iss, args);
+        return engine_position(args);
+    } else if (token == "takeback") {
+        if (!g_initialized) return "error: not initialized";
+        std::string err = g_game.takeback(iss);
+        if (!err.empty()) return err;
+        g_slice.active = false;
+        return "ok";
     } else if (token == "go") {
         int iters = 10000;
         iss >> iters;
         return engine_go(iters);
+    } else if (token == "setoption") {
+        // setoption name <name> value <value>
+        std::string tok, name, value;
+        iss >> tok >> name >> tok >> value;
+        return set_search_option(name, value) ? "ok" : "error: invalid option";
+    } else if (token == "ponder") {
+        int iters = 2000;
+        iss >> iters;
+        return engine_ponder(iters);
     } else if (token == "state") {
         return engine_get_state();
+    } else if (token == "stats") {
+        return engine_get_stats();
+    } else if (token == "bench") {
+        int iters = BENCH_ITERS;
+        iss >> iters;
+        return engine_bench(iters);
+    } else if (token == "profile") {
+        // profile [reset]: hot-path counters (profile builds only)
+        std::string arg;
+        iss >> arg;
+        if (arg == "reset") {
+            profile_reset();
+            return "ok";
+        }
+        return profile_report();
     } else if (token == "quit") {
         return "bye";
     }
@@ -121,6 +451,15 @@ EMSCRIPTEN_BINDINGS(gomoku_engine) {
     emscripten::function("engineInit", &engine_init);
     emscripten::function("engineUpdate", &engine_update);
     emscripten::function("engineGo", &engine_go);
+    emscripten::function("enginePonder", &engine_ponder);
     emscripten::function("engineGetState", &engine_get_state);
+    emscripten::function("engineGetStats", &engine_get_stats);
+    emscripten::function("engineBench", &engine_bench);
     emscripten::function("engineReset", &engine_reset);
+    emscripten::function("enginePosition", &engine_position);
+    emscripten::function("engineTakeback", &engine_takeback);
+    emscripten::function("engineSearchStart", &engine_search_start);
+    emscripten::function("engineSearchStep", &engine_search_step);
+    emscripten::function("engineSearchResult", &engine_search_result);
+    emscripten::function("engineAnalysis", &engine_analysis);
 }
@@ -3,7 +3,7 @@
 // Ties together Engine, Game State, and UI
 // ============================================================================
 
-import { GameState, SIDE_BLACK, SIDE_WHITE } from './game.js';
+import { GameState, SIDE_BLACK, SIDE_WHITE, MAX_SEARCH_ITERS } from './game.js';
 import { BoardRenderer } from './ui.js';
 import { EngineInterface } from './engine-interface.js';
 
@@ -22,6 +22,7 @@ class GomokuApp {
         this.resultText = document.getElementById('result-text');
         this.movetimeSelect = document.getElementById('movetime-select');
         this.sideSelect = document.getElementById('side-select');
+        this.ponderSelect = document.getElementById('ponder-select');
         this.newGameBtn = document.getElementById('new-game-btn');
         this.canvas = document.getElementById('board-canvas');
     }
@@ -43,7 +44,7 @@ class GomokuApp {
         // Initialize engine
         this._setStatus('Loading engine...');
         try {
-            await this.engine.init();
+            await this.engine.init({ maxIters: MAX_SEARCH_ITERS });
             this._setStatus('Engine ready. Your turn!');
             this._checkAITurn();
         } catch (err) {
@@ -64,6 +65,11 @@ class GomokuApp {
             this.game.movetime = parseFloat(e.target.value);
         });
         
+        // Ponder selector
+        this.ponderSelect.addEventListener('change', (e) => {
+            this.game.ponder = e.target.value === '1';
+        });
+        
         // Side selector
         this.sideSelect.addEventListener('change', (e) => {
             // Will apply on next new game
@@ -86,6 +92,9 @@ class GomokuApp {
      * Start new game
      */
     async newGame() {
+        // Abandon an AI move in progress; the engine reset follows at once
+        this.engine.cancel();
+        
         // Hide result overlay
         this.resultOverlay.classList.remove('visible');
         
@@ -93,6 +102,7 @@ class GomokuApp {
         this.game.reset();
         this.game.humanSide = parseInt(this.sideSelect.value);
         this.game.movetime = parseFloat(this.movetimeSelect.value);
+        this.game.ponder = this.ponderSelect.value === '1';
         
         // Clear renderer state
         this.renderer.clearWinLine();
@@ -157,7 +167,13 @@ class GomokuApp {
         
         try {
             const iters = this.game.getIterations();
+            this.engine.onProgress = (info) => {
+                const done = Math.min(100, Math.round(100 * info.iters / iters));
+                const winrate = (100 * info.winrate).toFixed(1);
+                this._setStatus(`AI is thinking... ${done}% (win rate ${winrate}%)`);
+            };
             const bestMove = await this.engine.go(iters);
+            if (bestMove === null) return;  // Cancelled by a new game (engine.cancel)
             
             if (bestMove >= 0 && bestMove < 225) {
                 await this._playMove(bestMove);
@@ -166,6 +182,8 @@ class GomokuApp {
                     this._handleGameOver();
                 } else {
                     this._setStatus('Your turn');
+                    // Keep searching while the human thinks
+                    if (this.game.ponder) this.engine.ponder();
                 }
             } else {
                 this._setStatus('AI returned invalid move');
@@ -173,6 +191,7 @@ class GomokuApp {
         } catch (err) {
             this._setStatus('AI error: ' + err.message);
         } finally {
+            this.engine.onProgress = null;
             this.game.isThinking = false;
             this.thinkingEl.classList.remove('visible');
         }
@@ -7,17 +7,27 @@ export class EngineInterface {
     constructor() {
         this.worker = null;
         this.ready = false;
+        this.simd = false;      // True once the simd128 module is running
+        this.threads = 1;       // Search threads (> 1 with the multithreaded module)
+        this.nodes = 0;         // Node pool size per search thread
         this.callbacks = new Map();
         this.pendingResolve = null;
+        this.searchResolve = null;  // Pending go() (other commands may run meanwhile)
+        this.searchId = 0;          // Id of the latest go(); replies to older ones are dropped
+        this.stopFlag = null;       // Engine stop flag in shared memory (multithreaded module)
+        this.onProgress = null;     // Called with go() progress: { iters, time, best, visits, winrate, heatmap }
         this.onReady = null;
         this.onError = null;
     }
 
     /**
      * Initialize the engine worker
+     * @param {Object} [options]
+     * @param {number} [options.maxIters] - Longest search that will be requested;
+     *        the engine sizes its node pools for it (and for device memory)
      * @returns {Promise<string>} Resolves when engine is ready
      */
-    init() {
+    init(options = {}) {
         return new Promise((resolve, reject) => {
             try {
                 this.worker = new Worker('js/engine-worker.js');
@@ -40,7 +50,7 @@ export class EngineInterface {
                 // Compute the absolute URL for the WASM JS glue
                 // This works on both root-hosted and subdirectory-hosted sites
                 const wasmUrl = new URL('wasm/gomoku_engine.js', window.location.href).href;
-                this.worker.postMessage({ type: 'init', data: { wasmUrl } });
+                this.worker.postMessage({ type: 'init', data: { wasmUrl, maxIters: options.maxIters } });
             } catch (err) {
                 reject(err);
             }
@@ -56,6 +66,12 @@ export class EngineInterface {
         switch (type) {
             case 'ready':
                 this.ready = true;
+                this.simd = !!msg.simd;  // simd128 build loaded
+                this.threads = msg.threads || 1;
+                this.nodes = msg.nodes || 0;  // Node budget per search thread
+                if (msg.stopFlag) {
+                    this.stopFlag = new Uint8Array(msg.stopFlag.buffer, msg.stopFlag.ptr, 1);
+                }
                 if (this.pendingResolve) {
                     this.pendingResolve.resolve(data);
                     this.pendingResolve = null;
@@ -78,12 +94,26 @@ export class EngineInterface {
                 break;
                 
             case 'bestmove':
-                if (this.pendingResolve) {
-                    // Parse "bestmove 112" -> 112
+                if (this.searchResolve && msg.id === this.searchId) {
+                    // Parse "bestmove 112" -> 112; null if the search was cancelled
                     const parts = data.split(' ');
                     const moveIndex = parseInt(parts[1], 10);
-                    this.pendingResolve.resolve(moveIndex);
-                    this.pendingResolve = null;
+                    this.searchResolve.resolve(msg.cancelled ? null : moveIndex);
+                    this.searchResolve = null;
+                }
+                break;
+                
+            case 'progress':
+                if (this.onProgress && msg.id === this.searchId) {
+                    const info = this._parseInfo(data);
+                    if (msg.heatmap) {
+                        // Root visits and wins x2 (side to move) by cell
+                        info.heatmap = {
+                            visits: msg.heatmap.subarray(0, 225),
+                            wins: msg.heatmap.subarray(225),
+                        };
+                    }
+                    this.onProgress(info);
                 }
                 break;
                 
@@ -94,9 +124,21 @@ export class EngineInterface {
                 }
                 break;
                 
+            case 'analysis':
+                if (this.pendingResolve) {
+                    this.pendingResolve.resolve(this._parseAnalysis(data));
+                    this.pendingResolve = null;
+                }
+                break;
+                
             case 'error':
                 if (this.onError) this.onError(data);
-                if (this.pendingResolve) {
+                if (msg.search) {
+                    if (this.searchResolve && msg.id === this.searchId) {
+                        this.searchResolve.reject(new Error(data));
+                        this.searchResolve = null;
+                    }
+                } else if (this.pendingResolve) {
                     this.pendingResolve.reject(new Error(data));
                     this.pendingResolve = null;
                 }
@@ -111,9 +153,55 @@ export class EngineInterface {
     }
 
     /**
-     * Parse engine state string
+     * Parse a search progress line:
+     * "info|done iters N time MS best M visits V winrate P"
+     */
+    _parseInfo(data) {
+        const parts = data.split(' ');
+        const info = { done: parts[0] === 'done' };
+        for (let i = 1; i + 1 < parts.length; i += 2) {
+            info[parts[i]] = parseFloat(parts[i + 1]);
+        }
+        return info;
+    }
+
+    /**
+     * Parse root analysis lines:
+     * "info move M visits V winrate P pv M ..." (most visited first)
+     */
+    _parseAnalysis(data) {
+        const moves = [];
+        for (const line of data.split('\n')) {
+            const parts = line.split(' ');
+            if (parts[0] !== 'info') continue;
+            const pv = parts.indexOf('pv');
+            moves.push({
+                move: parseInt(parts[2], 10),
+                visits: parseInt(parts[4], 10),
+                winrate: parseFloat(parts[6]),     // Side to move
+                pv: pv < 0 ? [] : parts.slice(pv + 1).map(Number),
+            });
+        }
+        return moves;
+    }
+
+    /**
+     * Parse engine state: the binary form ({ cells, words }, layout in
+     * main_wasm.cpp) or the older string form
      */
     _parseState(data) {
+        if (data.words) {
+            const w = data.words;
+            return {
+                cnt: w[0], side: w[1], res: w[2], last: w[3],
+                board: data.cells,                 // Uint8Array: 0=empty, 1=black, 2=white
+                best: w[4],                        // -1 unless the tree root is this position
+                rootVisits: w[5],
+                winrate: w[5] > 0 ? w[6] / (2 * w[5]) : 0.5,   // Side to move
+                iters: w[7], timeMs: w[8], nodes: w[9],
+                children: w.subarray(16),          // (move, visits, wins x2) triples
+            };
+        }
         const state = {};
         const parts = data.replace('state ', '').split(' ');
         for (const part of parts) {
@@ -141,18 +229,114 @@ export class EngineInterface {
     }
 
     /**
-     * Ask engine to find the best move
+     * Set the whole position in one message
+     * @param {number[]} moves - Moves from the empty board
+     * @returns {Promise<string>} "ok" or an error message
+     */
+    position(moves) {
+        return new Promise((resolve, reject) => {
+            if (!this.ready) return reject(new Error('Engine not ready'));
+            this.pendingResolve = { resolve, reject };
+            const args = moves.length ? 'startpos moves ' + moves.join(' ') : 'startpos';
+            this.worker.postMessage({ type: 'position', data: { args } });
+        });
+    }
+
+    /**
+     * Undo the last moves (the engine keeps its tree where it can)
+     * @param {number} count - Number of moves to take back
+     * @returns {Promise<string>} "ok" or an error message
+     */
+    takeback(count = 1) {
+        return new Promise((resolve, reject) => {
+            if (!this.ready) return reject(new Error('Engine not ready'));
+            this.pendingResolve = { resolve, reject };
+            this.worker.postMessage({ type: 'takeback', data: { count } });
+        });
+    }
+
+    /**
+     * Ask engine to find the best move. The worker searches in slices,
+     * reporting through onProgress, and stays responsive: stop() ends the
+     * search early with the best move so far, state queries are answered
+     * meanwhile, and any other command cancels it.
+     * @param {number} iters - Number of MCTS iterations (0 = only movetime)
+     * @param {number} movetime - Time limit in ms (0 = only iters)
+     * @returns {Promise<number|null>} Best move index, null if cancelled
+     */
+    go(iters = 10000, movetime = 0) {
+        return new Promise((resolve, reject) => {
+            if (!this.ready) return reject(new Error('Engine not ready'));
+            this.searchResolve = { resolve, reject };
+            const id = ++this.searchId;
+            this.worker.postMessage({ type: 'go', data: { iters, movetime, id } });
+        });
+    }
+
+    /**
+     * End a running go() search now; its promise resolves with the best
+     * move found so far. With the multithreaded module the shared stop
+     * flag ends it mid-slice.
+     */
+    stop() {
+        if (!this.ready) return;
+        if (this.stopFlag) Atomics.store(this.stopFlag, 0, 1);
+        this.worker.postMessage({ type: 'stop' });
+    }
+
+    /**
+     * Abandon a running go() search (new game, undo): its promise resolves
+     * with null at once and the engine stops searching, so the next command
+     * is handled within milliseconds instead of after the search. Any late
+     * reply from the search is dropped.
+     */
+    cancel() {
+        if (!this.searchResolve) return;
+        this.searchResolve.resolve(null);
+        this.searchResolve = null;
+        this.searchId++;
+        if (this.stopFlag) Atomics.store(this.stopFlag, 0, 1);
+    }
+
+    /**
+     * Search and return the resulting state (best move and root move
+     * statistics) in binary form; needs a module built with the binary
+     * interface
      * @param {number} iters - Number of MCTS iterations
-     * @returns {Promise<number>} Best move index
+     * @returns {Promise<object>} State as returned by getState()
      */
-    go(iters = 10000) {
+    search(iters = 10000) {
         return new Promise((resolve, reject) => {
             if (!this.ready) return reject(new Error('Engine not ready'));
             this.pendingResolve = { resolve, reject };
-            this.worker.postMessage({ type: 'go', data: { iters } });
+            this.worker.postMessage({ type: 'search', data: { iters } });
         });
     }
 
+    /**
+     * Root moves of the current search tree, most visited first, with their
+     * win rates and principal variations. Answered during a go() search too.
+     * @param {number} maxMoves - Moves to list (0 = all)
+     * @returns {Promise<Array<{move, visits, winrate, pv}>>} Empty if the
+     *          tree holds no search of the current position
+     */
+    analysis(maxMoves = 0) {
+        return new Promise((resolve, reject) => {
+            if (!this.ready) return reject(new Error('Engine not ready'));
+            this.pendingResolve = { resolve, reject };
+            this.worker.postMessage({ type: 'analysis', data: { maxMoves } });
+        });
+    }
+
+    /**
+     * Start thinking on the opponent's time. Runs in the worker until the
+     * next command arrives; no reply is sent.
+     */
+    ponder() {
+        if (!this.ready) return;
+        this.worker.postMessage({ type: 'ponder' });
+    }
+
     /**
      * Reset the board to initial state
      * @returns {Promise<string>}
@@ -6,21 +6,202 @@
 let Module = null;
 let engineReady = false;
 
-async function initEngine(wasmUrl) {
+// Pondering: search the position in short slices while the human thinks,
+// yielding to the message loop between slices so any command stops it
+const PONDER_SLICE_ITERS = 2000;
+let pondering = false;
+
+function ponderStep() {
+    if (!pondering) return;
+    const result = Module.enginePonder(PONDER_SLICE_ITERS);
+    if (!result.startsWith('ponder')) {
+        pondering = false;
+        return;
+    }
+    setTimeout(ponderStep, 0);
+}
+
+// Time-sliced search for go: the engine searches in SEARCH_SLICE_MS slices
+// and the message loop runs between them, so stop, state queries and new
+// commands are handled within a slice, and progress is streamed to the
+// page. Slices are chained through a MessageChannel rather than setTimeout,
+// which browsers clamp to 4 ms.
+const SEARCH_SLICE_MS = 50;
+let searching = false;
+let searchId = 0;           // Echoed in progress/bestmove so the page can drop stale replies
+const sliceChannel = new MessageChannel();
+sliceChannel.port1.onmessage = searchSlice;
+
+function hasSlicedSearch() {
+    return typeof Module.engineSearchStart === 'function';
+}
+
+function searchSlice() {
+    if (!searching) return;
+    const info = Module.engineSearchStep(SEARCH_SLICE_MS);
+    if (info.startsWith('error')) {
+        searching = false;
+        self.postMessage({ type: 'error', data: info, search: true, id: searchId });
+        return;
+    }
+    // Each slice refreshes the heatmap buffer; send a copy along
+    if (hasBinaryState()) {
+        const heatmap = heatmapCopy();
+        self.postMessage({ type: 'progress', data: info, heatmap, id: searchId }, [heatmap.buffer]);
+    } else {
+        self.postMessage({ type: 'progress', data: info, id: searchId });
+    }
+    if (info.startsWith('done')) {
+        finishSearch(false);
+    } else {
+        sliceChannel.port2.postMessage(null);
+    }
+}
+
+// Reply to go: with the best move so far, or with -1 if a command that
+// changes the position cancelled the search
+function finishSearch(cancelled) {
+    searching = false;
+    const result = Module.engineSearchResult();
+    self.postMessage({ type: 'bestmove', data: cancelled ? 'bestmove -1' : result, cancelled, id: searchId });
+}
+
+// Binary state (see the binary interface in main_wasm.cpp): the engine
+// writes into static buffers that we read through typed-array views.
+// Views are recreated when memory growth replaces the heap buffer.
+const STATE_HEADER = 16;
+const STATE_CHILDREN = 10;
+const STATE_WORDS = STATE_HEADER + 3 * 225;
+let heapBuffer = null;
+let cellsView = null;
+let stateView = null;
+let heatmapView = null;     // 2 x 225: root visits by cell, then wins x2 for the side to move
+
+function hasBinaryState() {
+    return typeof Module._engine_write_state === 'function' && Module.HEAPU8 !== undefined;
+}
+
+function updateViews() {
+    if (Module.HEAPU8.buffer === heapBuffer) return;
+    heapBuffer = Module.HEAPU8.buffer;
+    cellsView = new Uint8Array(heapBuffer, Module._engine_cells_ptr(), 225);
+    stateView = new Int32Array(heapBuffer, Module._engine_state_ptr(), STATE_WORDS);
+    heatmapView = typeof Module._engine_heatmap_ptr === 'function'
+        ? new Int32Array(heapBuffer, Module._engine_heatmap_ptr(), 2 * 225) : null;
+}
+
+function heatmapCopy() {
+    updateViews();
+    return heatmapView ? heatmapView.slice() : new Int32Array(2 * 225);
+}
+
+// Copy the buffers out (one memcpy each) and transfer them to the main thread
+function postState(type) {
+    updateViews();
+    const cells = cellsView.slice();
+    const words = stateView.slice(0, STATE_HEADER + 3 * stateView[STATE_CHILDREN]);
+    self.postMessage({ type, data: { cells, words } }, [cells.buffer, words.buffer]);
+}
+
+// WebAssembly SIMD support: validate a minimal module using a simd128
+// instruction (i8x16.splat + i8x16.popcnt)
+function simdSupported() {
     try {
-        // Import the WASM JS glue from the URL provided by the main thread
-        self.importScripts(wasmUrl);
+        return WebAssembly.validate(new Uint8Array([
+            0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0,
+            10, 10, 1, 8, 0, 65, 0, 253, 15, 253, 98, 11
+        ]));
+    } catch (err) {
+        return false;
+    }
+}
+
+// Multithreaded module: Emscripten pthreads need SharedArrayBuffer, which
+// browsers only provide to cross-origin isolated pages (COOP/COEP headers,
+// as sent by serve.py). MT_MAX_THREADS must match PTHREAD_POOL_SIZE + 1 in
+// the wasm-mt build, since helper threads cannot be started on demand
+// while a search blocks this worker.
+const MT_MAX_THREADS = 8;
+
+function threadsSupported() {
+    return self.crossOriginIsolated === true && typeof SharedArrayBuffer !== 'undefined';
+}
+
+// Node budget per search thread (the engine's NODES option), set before
+// the first search allocates the pools: a sixteenth of device memory
+// (navigator.deviceMemory in GB, Chromium only; 4 GB assumed elsewhere),
+// capped by three quarters of the module's memory ceiling and by what the
+// longest search can use (tree reuse keeps a tree while less than half the
+// pool is in use, so twice its iterations).
+const NODE_BYTES = 44;              // Node plus its share of the move order pool
+const MIN_NODE_BUDGET = 10000;      // NODES option range in the engine
+const MAX_NODE_BUDGET = 10000000;
+const DEFAULT_MAX_ITERS = 3000000;
+
+function nodeBudget(build, threads, maxIters) {
+    const deviceBytes = (self.navigator.deviceMemory || 4) * 1024 * 1024 * 1024;
+    const byDevice = deviceBytes / 16 / NODE_BYTES / threads;
+    const byHeap = build.maxMemoryMB * 1024 * 1024 * 0.75 / NODE_BYTES / threads;
+    const bySearch = 2 * (maxIters || DEFAULT_MAX_ITERS);
+    const budget = Math.floor(Math.min(byDevice, byHeap, bySearch, MAX_NODE_BUDGET));
+    return Math.max(MIN_NODE_BUDGET, budget);
+}
+
+async function initEngine(wasmUrl, maxIters) {
+    try {
+        // Import the WASM JS glue from the URL provided by the main thread.
+        // Preference: the multithreaded simd128 build (gomoku_engine_mt.js)
+        // when the page is cross-origin isolated, then the simd128 build
+        // (gomoku_engine_simd.js), then the scalar build. A build that is
+        // missing is skipped.
+        const candidates = [];
+        if (simdSupported()) {
+            if (threadsSupported()) {
+                candidates.push({ suffix: '_mt', simd: true, threads: true, maxMemoryMB: 2048 });
+            }
+            candidates.push({ suffix: '_simd', simd: true, threads: false, maxMemoryMB: 1024 });
+        }
+        candidates.push({ suffix: '', simd: false, threads: false, maxMemoryMB: 1024 });
+        let build = null;
+        for (const candidate of candidates) {
+            const url = wasmUrl.replace(/\.js$/, candidate.suffix + '.js');
+            try {
+                self.importScripts(url);
+            } catch (err) {
+                if (candidate.suffix === '') throw err;
+                continue;
+            }
+            wasmUrl = url;
+            build = candidate;
+            break;
+        }
         
         // Determine the directory containing the WASM files
         const wasmDir = wasmUrl.substring(0, wasmUrl.lastIndexOf('/') + 1);
         
-        // Initialize with locateFile so Emscripten finds the .wasm binary
+        // Initialize with locateFile so Emscripten finds the .wasm binary;
+        // pthread workers load the glue from mainScriptUrlOrBlob
         Module = await GomokuEngine({
-            locateFile: (path) => wasmDir + path
+            locateFile: (path) => wasmDir + path,
+            mainScriptUrlOrBlob: wasmUrl
         });
         const result = Module.engineInit();
+        let threads = 1;
+        if (build.threads) {
+            threads = Math.max(1, Math.min(navigator.hardwareConcurrency || 1, MT_MAX_THREADS));
+            Module.engineCommand('setoption name Threads value ' + threads);
+        }
+        const nodes = nodeBudget(build, threads, maxIters);
+        Module.engineCommand('setoption name NODES value ' + nodes);
+        // With a shared heap (multithreaded module) the page gets the stop
+        // flag's memory, so it can stop a search without waiting for a slice
+        let stopFlag = null;
+        if (typeof Module._engine_stop_ptr === 'function' && typeof SharedArrayBuffer !== 'undefined' &&
+            Module.HEAPU8.buffer instanceof SharedArrayBuffer) {
+            stopFlag = { buffer: Module.HEAPU8.buffer, ptr: Module._engine_stop_ptr() };
+        }
         engineReady = true;
-        self.postMessage({ type: 'ready', data: result });
+        self.postMessage({ type: 'ready', data: result, simd: build.simd, threads, nodes, stopFlag });
     } catch (err) {
         self.postMessage({ type: 'error', data: 'Failed to load engine: ' + err.message });
     }
@@ -35,10 +216,20 @@ self.onmessage = function(e) {
         return;
     }
     
+    // Every command other than ponder ends the ponder search (the tree is kept)
+    if (type !== 'ponder') pondering = false;
+    
+    // A running go search answers stop with its move and keeps going
+    // through state queries; any other command cancels it
+    if (searching && type !== 'state' && type !== 'stats' && type !== 'analysis') {
+        finishSearch(type !== 'stop');
+        if (type === 'stop') return;
+    }
+    
     try {
         switch (type) {
             case 'init':
-                initEngine(data.wasmUrl);
+                initEngine(data.wasmUrl, data.maxIters);
                 break;
                 
             case 'reset': {
@@ -53,16 +244,82 @@ self.onmessage = function(e) {
                 break;
             }
             
+            case 'position': {
+                const result = Module.enginePosition(data.args);
+                self.postMessage({ type: 'position', data: result });
+                break;
+            }
+            
+            case 'takeback': {
+                const result = Module.engineTakeback(data.count || 1);
+                self.postMessage({ type: 'takeback', data: result });
+                break;
+            }
+            
             case 'go': {
-                const iters = data.iters || 10000;
-                const result = Module.engineGo(iters);
-                self.postMessage({ type: 'bestmove', data: result });
+                const iters = data.iters || 0;
+                const movetime = data.movetime || 0;
+                searchId = data.id || 0;
+                if (!hasSlicedSearch()) {
+                    const result = Module.engineGo(iters || 10000);
+                    self.postMessage({ type: 'bestmove', data: result, id: searchId });
+                    break;
+                }
+                const result = Module.engineSearchStart(iters, movetime);
+                if (result !== 'ok') {
+                    self.postMessage({ type: 'error', data: result, search: true, id: searchId });
+                    break;
+                }
+                searching = true;
+                sliceChannel.port2.postMessage(null);
+                break;
+            }
+            
+            case 'stop':
+                // No search running: nothing to stop, no reply
+                break;
+            
+            case 'stats': {
+                const result = Module.engineGetStats();
+                self.postMessage({ type: 'stats', data: result });
+                break;
+            }
+            
+            case 'ponder': {
+                if (!pondering) {
+                    pondering = true;
+                    setTimeout(ponderStep, 0);
+                }
                 break;
             }
             
             case 'state': {
-                const result = Module.engineGetState();
-                self.postMessage({ type: 'state', data: result });
+                if (hasBinaryState()) {
+                    Module._engine_write_state();
+                    postState('state');
+                } else {
+                    const result = Module.engineGetState();
+                    self.postMessage({ type: 'state', data: result });
+                }
+                break;
+            }
+            
+            case 'search': {
+                // Like go, but replies with the binary state (best move and root statistics)
+                if (!hasBinaryState()) {
+                    self.postMessage({ type: 'error', data: 'Binary interface not available' });
+                    break;
+                }
+                Module._engine_search(data.iters || 10000);
+                postState('state');
+                break;
+            }
+            
+            case 'analysis': {
+                // Root moves of the current search tree with their PVs
+                const result = typeof Module.engineAnalysis === 'function'
+                    ? Module.engineAnalysis(data.maxMoves || 0) : '';
+                self.postMessage({ type: 'analysis', data: result });
                 break;
             }
             
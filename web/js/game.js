@@ -27,6 +27,9 @@ const MOVETIME_TO_ITERS = {
     30:  3000000
 };
 
+// Longest search the UI asks for (sizes the engine's node pools)
+export const MAX_SEARCH_ITERS = Math.max(...Object.values(MOVETIME_TO_ITERS));
+
 export class GameState {
     constructor() {
         this.reset();
@@ -47,6 +50,7 @@ export class GameState {
         // Game settings
         this.humanSide = SIDE_BLACK; // Human plays black by default
         this.movetime = 1; // Default 1 second
+        this.ponder = true; // Think while the human thinks
         
         // State flags
         this.isThinking = false;